@@ -3,21 +3,358 @@
 
 #include <AL/Collections/Array.hpp>
 #include <AL/Collections/Queue.hpp>
+#include <AL/Collections/ArrayList.hpp>
 #include <AL/Collections/LinkedList.hpp>
 #include <AL/Collections/Dictionary.hpp>
 
+#include <AL/OS/Timer.hpp>
+
 #include <AL/Network/TcpSocket.hpp>
 #include <AL/Network/SocketExtensions.hpp>
 
+#include <atomic>
+#include <thread>
+#include <cstring>
+
 #if defined(AL_PLATFORM_WINDOWS)
 	#undef SendMessage
 #endif
 
+#if defined(__AVX2__)
+	#define APRS_TOKENIZER_AVX2
+
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#define APRS_TOKENIZER_SSE2
+
+	#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
 #define APRS_SOFTWARE_NAME    "libAPRS-IS"
 #define APRS_SOFTWARE_VERSION "0.2"
 
 namespace APRS
 {
+	struct TokenizerLine
+	{
+		static constexpr AL::size_t MAX_DELIMITERS = 32;
+
+		// offset of the line within the tokenized buffer
+		AL::size_t Offset;
+		// length excluding the line terminator
+		AL::size_t Length;
+		// may exceed MAX_DELIMITERS, only the first MAX_DELIMITERS offsets are recorded
+		AL::size_t DelimiterCount;
+		// offsets of '>', ',' and ':' relative to Offset
+		AL::uint32 Delimiters[MAX_DELIMITERS];
+	};
+
+	// Finds line feeds and header delimiters 64 bytes at a time (AVX2, SSE2 or scalar)
+	class Tokenizer
+	{
+	public:
+		static constexpr AL::size_t BLOCK_SIZE = 64;
+
+		static bool IsDelimiter(AL::String::Char c)
+		{
+			switch (c)
+			{
+				case '>':
+				case ',':
+				case ':':
+					return true;
+			}
+
+			return false;
+		}
+
+		static AL::size_t CountTrailingZeros(AL::uint64 value)
+		{
+#if defined(_MSC_VER)
+			unsigned long index;
+			_BitScanForward64(&index, value);
+
+			return index;
+#else
+			return static_cast<AL::size_t>(__builtin_ctzll(value));
+#endif
+		}
+
+		// @return size if not found
+		static AL::size_t Find(const AL::String::Char* lpBuffer, AL::size_t size, AL::String::Char value)
+		{
+			AL::size_t i = 0;
+
+#if defined(APRS_TOKENIZER_AVX2)
+			auto needle = _mm256_set1_epi8(value);
+
+			for (; (i + 32) <= size; i += 32)
+			{
+				auto mask = static_cast<AL::uint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&lpBuffer[i])), needle)));
+
+				if (mask != 0)
+				{
+
+					return i + CountTrailingZeros(mask);
+				}
+			}
+#elif defined(APRS_TOKENIZER_SSE2)
+			auto needle = _mm_set1_epi8(value);
+
+			for (; (i + 16) <= size; i += 16)
+			{
+				auto mask = static_cast<AL::uint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&lpBuffer[i])), needle)));
+
+				if (mask != 0)
+				{
+
+					return i + CountTrailingZeros(mask);
+				}
+			}
+#endif
+
+			for (; i < size; ++i)
+			{
+				if (lpBuffer[i] == value)
+				{
+
+					return i;
+				}
+			}
+
+			return size;
+		}
+
+		// Note: lpBlock must have BLOCK_SIZE readable bytes
+		static void Classify(const AL::String::Char* lpBlock, AL::uint64& lineFeeds, AL::uint64& delimiters)
+		{
+#if defined(APRS_TOKENIZER_AVX2)
+			auto lf    = _mm256_set1_epi8('\n');
+			auto gt    = _mm256_set1_epi8('>');
+			auto comma = _mm256_set1_epi8(',');
+			auto colon = _mm256_set1_epi8(':');
+
+			lineFeeds  = 0;
+			delimiters = 0;
+
+			for (AL::size_t i = 0; i < BLOCK_SIZE; i += 32)
+			{
+				auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&lpBlock[i]));
+
+				lineFeeds  |= static_cast<AL::uint64>(static_cast<AL::uint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, lf)))) << i;
+				delimiters |= static_cast<AL::uint64>(static_cast<AL::uint32>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, gt), _mm256_cmpeq_epi8(chunk, comma)), _mm256_cmpeq_epi8(chunk, colon))))) << i;
+			}
+#elif defined(APRS_TOKENIZER_SSE2)
+			auto lf    = _mm_set1_epi8('\n');
+			auto gt    = _mm_set1_epi8('>');
+			auto comma = _mm_set1_epi8(',');
+			auto colon = _mm_set1_epi8(':');
+
+			lineFeeds  = 0;
+			delimiters = 0;
+
+			for (AL::size_t i = 0; i < BLOCK_SIZE; i += 16)
+			{
+				auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&lpBlock[i]));
+
+				lineFeeds  |= static_cast<AL::uint64>(static_cast<AL::uint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, lf)))) << i;
+				delimiters |= static_cast<AL::uint64>(static_cast<AL::uint32>(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, gt), _mm_cmpeq_epi8(chunk, comma)), _mm_cmpeq_epi8(chunk, colon))))) << i;
+			}
+#else
+			ClassifyScalar(lpBlock, lineFeeds, delimiters);
+#endif
+		}
+
+		// Note: lpBlock must have BLOCK_SIZE readable bytes
+		static void ClassifyScalar(const AL::String::Char* lpBlock, AL::uint64& lineFeeds, AL::uint64& delimiters)
+		{
+			lineFeeds  = 0;
+			delimiters = 0;
+
+			for (AL::size_t i = 0; i < BLOCK_SIZE; ++i)
+			{
+				if (lpBlock[i] == '\n')
+					lineFeeds |= AL::uint64(1) << i;
+				else if (IsDelimiter(lpBlock[i]))
+					delimiters |= AL::uint64(1) << i;
+			}
+		}
+
+		// Splits lpBuffer on '\n' (stripping a preceding '\r') and records the header delimiters of each line
+		// Note: a trailing line without a terminator is not returned
+		// @return number of lines written to lpLines
+		static AL::size_t Tokenize(const AL::String::Char* lpBuffer, AL::size_t size, TokenizerLine* lpLines, AL::size_t maxLines, AL::size_t& consumed)
+		{
+			consumed = 0;
+
+			if (maxLines == 0)
+			{
+
+				return 0;
+			}
+
+			AL::size_t count  = 0;
+			auto       lpLine = &lpLines[0];
+
+			lpLine->Offset         = 0;
+			lpLine->DelimiterCount = 0;
+
+			for (AL::size_t block = 0; block < size; block += BLOCK_SIZE)
+			{
+				AL::uint64 lineFeeds, delimiters;
+				ClassifyBlock(&lpBuffer[block], size - block, lineFeeds, delimiters);
+
+				for (auto bits = lineFeeds | delimiters; bits != 0; bits &= bits - 1)
+				{
+					auto bit    = CountTrailingZeros(bits);
+					auto offset = block + bit;
+
+					if ((lineFeeds & (AL::uint64(1) << bit)) == 0)
+					{
+						if (lpLine->DelimiterCount < TokenizerLine::MAX_DELIMITERS)
+						{
+
+							lpLine->Delimiters[lpLine->DelimiterCount] = static_cast<AL::uint32>(offset - lpLine->Offset);
+						}
+
+						++lpLine->DelimiterCount;
+
+						continue;
+					}
+
+					auto end = offset;
+
+					if ((end > lpLine->Offset) && (lpBuffer[end - 1] == '\r'))
+					{
+
+						--end;
+					}
+
+					lpLine->Length = end - lpLine->Offset;
+					consumed       = offset + 1;
+
+					if (++count == maxLines)
+					{
+
+						return count;
+					}
+
+					lpLine                 = &lpLines[count];
+					lpLine->Offset         = offset + 1;
+					lpLine->DelimiterCount = 0;
+				}
+			}
+
+			return count;
+		}
+
+		// Records the header delimiters of a single line without a terminator
+		static void TokenizeLine(const AL::String::Char* lpBuffer, AL::size_t size, TokenizerLine& line)
+		{
+			line.Offset         = 0;
+			line.Length         = size;
+			line.DelimiterCount = 0;
+
+			for (AL::size_t block = 0; block < size; block += BLOCK_SIZE)
+			{
+				AL::uint64 lineFeeds, delimiters;
+				ClassifyBlock(&lpBuffer[block], size - block, lineFeeds, delimiters);
+
+				for (; delimiters != 0; delimiters &= delimiters - 1)
+				{
+					if (line.DelimiterCount < TokenizerLine::MAX_DELIMITERS)
+					{
+
+						line.Delimiters[line.DelimiterCount] = static_cast<AL::uint32>(block + CountTrailingZeros(delimiters));
+					}
+
+					++line.DelimiterCount;
+				}
+			}
+		}
+
+		// @return offset of the first value at or after offset, or line.Length if not found
+		static AL::size_t FindDelimiter(const AL::String::Char* lpLine, const TokenizerLine& line, AL::size_t offset, AL::String::Char value)
+		{
+			AL::size_t count = (line.DelimiterCount < TokenizerLine::MAX_DELIMITERS) ? line.DelimiterCount : TokenizerLine::MAX_DELIMITERS;
+
+			for (AL::size_t i = 0; i < count; ++i)
+			{
+				if ((line.Delimiters[i] >= offset) && (lpLine[line.Delimiters[i]] == value))
+				{
+
+					return line.Delimiters[i];
+				}
+			}
+
+			if (line.DelimiterCount > TokenizerLine::MAX_DELIMITERS)
+			{
+				AL::size_t last = line.Delimiters[TokenizerLine::MAX_DELIMITERS - 1] + 1;
+
+				if (offset < last)
+				{
+
+					offset = last;
+				}
+
+				if (offset < line.Length)
+				{
+
+					return offset + Find(&lpLine[offset], line.Length - offset, value);
+				}
+			}
+
+			return line.Length;
+		}
+
+	private:
+		static void ClassifyBlock(const AL::String::Char* lpBlock, AL::size_t size, AL::uint64& lineFeeds, AL::uint64& delimiters)
+		{
+			if (size >= BLOCK_SIZE)
+			{
+				Classify(lpBlock, lineFeeds, delimiters);
+
+				return;
+			}
+
+			AL::String::Char block[BLOCK_SIZE] = {};
+			::memcpy(block, lpBlock, size);
+
+			Classify(block, lineFeeds, delimiters);
+		}
+	};
+
+	enum class DataTypes : AL::uint8
+	{
+		Unknown,
+		Item,
+		Object,
+		Status,
+		Message,
+		Weather,
+		Position,
+		Telemetry
+	};
+
+	// Field boundaries of a line as found by Packet::Decode, relative to the start of the line
+	struct PacketSpan
+	{
+		// offset of '>' (also the sender length)
+		AL::size_t ToCall;
+		// offset of the ',' ending tocall
+		AL::size_t DigiPath;
+		// offset of the 3 character q construct
+		AL::size_t QFlag;
+		// offset of the ',' ending the q construct
+		AL::size_t IGate;
+		// offset of the ':' preceding the content
+		AL::size_t Content;
+	};
+
 	struct Packet
 	{
 		AL::String IGate;
@@ -28,39 +365,56 @@ namespace APRS
 		AL::String DigiPath;
 
 		bool IsMessage() const
+		{
+			return GetDataType() == DataTypes::Message;
+		}
+		bool IsPosition() const
+		{
+			return GetDataType() == DataTypes::Position;
+		}
+
+		DataTypes GetDataType() const
 		{
 			if (Content.GetLength() == 0)
 			{
 
-				return false;
-			}
-
-			switch (*Content.GetCString())
-			{
-				case ':':
-					return true;
+				return DataTypes::Unknown;
 			}
 
-			return false;
+			return GetDataType(*Content.GetCString());
 		}
-		bool IsPosition() const
+
+		// @param value first character of Content
+		static DataTypes GetDataType(AL::String::Char value)
 		{
-			if (Content.GetLength() == 0)
+			switch (value)
 			{
+				case ')':
+					return DataTypes::Item;
 
-				return false;
-			}
+				case ';':
+					return DataTypes::Object;
+
+				case '>':
+					return DataTypes::Status;
+
+				case ':':
+					return DataTypes::Message;
+
+				case '_':
+					return DataTypes::Weather;
 
-			switch (*Content.GetCString())
-			{
 				case '!':
 				case '=':
 				// case '/':
 				// case '@':
-					return true;
+					return DataTypes::Position;
+
+				case 'T':
+					return DataTypes::Telemetry;
 			}
 
-			return false;
+			return DataTypes::Unknown;
 		}
 
 		AL::String Encode() const
@@ -75,6 +429,98 @@ namespace APRS
 		}
 
 		static bool Decode(Packet& packet, const AL::String& string)
+		{
+			TokenizerLine line;
+			Tokenizer::TokenizeLine(string.GetCString(), string.GetLength(), line);
+
+			return Decode(packet, string.GetCString(), line);
+		}
+		// @param lpLine first byte of the line described by line
+		static bool Decode(Packet& packet, const AL::String::Char* lpLine, const TokenizerLine& line)
+		{
+			PacketSpan span;
+
+			if (!Decode(span, lpLine, line))
+			{
+
+				return false;
+			}
+
+			packet.IGate    = AL::String(&lpLine[span.IGate + 1], span.Content - span.IGate - 1);
+			packet.QFlag    = AL::String(&lpLine[span.QFlag], 3);
+			packet.ToCall   = AL::String(&lpLine[span.ToCall + 1], span.DigiPath - span.ToCall - 1);
+			packet.Sender   = AL::String(lpLine, span.ToCall);
+			packet.Content  = AL::String(&lpLine[span.Content + 1], line.Length - span.Content - 1);
+			packet.DigiPath = (span.QFlag > (span.DigiPath + 1)) ? AL::String(&lpLine[span.DigiPath + 1], span.QFlag - span.DigiPath - 2) : AL::String();
+
+			return true;
+		}
+		// Finds the field boundaries of a line without copying any field
+		// @param lpLine first byte of the line described by line
+		static bool Decode(PacketSpan& span, const AL::String::Char* lpLine, const TokenizerLine& line)
+		{
+			if ((line.Length == 0) || (lpLine[0] == '#'))
+			{
+
+				return false;
+			}
+
+			// mirrors DecodeRegex: the first q construct followed by a non-empty igate and content wins
+			auto length = line.Length;
+			auto gt     = Tokenizer::FindDelimiter(lpLine, line, 0, '>');
+
+			if ((gt == 0) || (gt == length))
+			{
+
+				return false;
+			}
+
+			auto comma = Tokenizer::FindDelimiter(lpLine, line, gt + 1, ',');
+
+			if ((comma == (gt + 1)) || (comma == length))
+			{
+
+				return false;
+			}
+
+			for (auto offset = comma + 1; ; )
+			{
+				auto end = Tokenizer::FindDelimiter(lpLine, line, offset, ',');
+
+				if ((end == offset) || (end == length))
+				{
+
+					return false;
+				}
+
+				if (((end - offset) == 3) && (lpLine[offset] == 'q') && IsUpper(lpLine[offset + 1]) && IsUpper(lpLine[offset + 2]))
+				{
+					auto colon = Tokenizer::FindDelimiter(lpLine, line, end + 1, ':');
+
+					if (colon == length)
+					{
+
+						return false;
+					}
+
+					if ((colon > (end + 1)) && ((colon + 1) < length) && !ContainsLineTerminator(&lpLine[colon + 1], length - colon - 1))
+					{
+						span.ToCall   = gt;
+						span.DigiPath = comma;
+						span.QFlag    = offset;
+						span.IGate    = end;
+						span.Content  = colon;
+
+						return true;
+					}
+				}
+
+				offset = end + 1;
+			}
+		}
+
+		// Reference implementation of Decode
+		static bool DecodeRegex(Packet& packet, const AL::String& string)
 		{
 			if (!string.StartsWith('#'))
 			{
@@ -105,6 +551,17 @@ namespace APRS
 
 			return false;
 		}
+
+	private:
+		static bool IsUpper(AL::String::Char c)
+		{
+			return (c >= 'A') && (c <= 'Z');
+		}
+
+		static bool ContainsLineTerminator(const AL::String::Char* lpBuffer, AL::size_t size)
+		{
+			return (Tokenizer::Find(lpBuffer, size, '\n') != size) || (Tokenizer::Find(lpBuffer, size, '\r') != size);
+		}
 	};
 
 	struct Message
@@ -112,6 +569,8 @@ namespace APRS
 		AL::String Ack;
 		AL::String Content;
 		AL::String Destination;
+		// id of the last message received from Destination, acknowledged in the {MM}AA reply-ack format
+		AL::String ReplyAck;
 
 		Packet Encode(const AL::String& tocall, const AL::String& sender, const AL::String& digipath) const
 		{
@@ -128,6 +587,13 @@ namespace APRS
 				packet.Content.Append(
 					AL::String::Format("{%s", Ack.GetCString())
 				);
+
+				if (ReplyAck.GetLength() != 0)
+				{
+					packet.Content.Append(
+						AL::String::Format("}%s", ReplyAck.GetCString())
+					);
+				}
 			}
 
 			return packet;
@@ -149,12 +615,26 @@ namespace APRS
 			if (!AL::Regex::Match(matches, "^(.*)\\{(.+)$", content))
 			{
 				message.Ack.Clear();
+				message.ReplyAck.Clear();
 				message.Content = AL::Move(content);
 			}
 			else
 			{
-				message.Ack     = AL::Move(matches[2]);
 				message.Content = AL::Move(matches[1]);
+
+				auto& ack    = matches[2];
+				auto  length = Tokenizer::Find(ack.GetCString(), ack.GetLength(), '}');
+
+				if (length == ack.GetLength())
+				{
+					message.Ack = AL::Move(ack);
+					message.ReplyAck.Clear();
+				}
+				else
+				{
+					message.Ack      = AL::String(ack.GetCString(), length);
+					message.ReplyAck = AL::String(&ack.GetCString()[length + 1], ack.GetLength() - length - 1);
+				}
 			}
 
 			return true;
@@ -171,39 +651,172 @@ namespace APRS
 		AL::String::Char SymbolTable;
 		AL::String::Char SymbolTableKey;
 
-		Packet Encode(const AL::String& tocall, const AL::String& sender, const AL::String& digipath) const
+		// fixed-point coordinates are stored in millionths of a degree
+		static constexpr AL::int32 FIXED_POINT_SCALE = 1000000;
+
+		static AL::int32 ToFixedPoint(AL::Float degrees)
 		{
-			AL::int16  latitude_hours   = 0, longitude_hours   = 0;
-			AL::uint16 latitude_minutes = 0, longitude_minutes = 0;
-			AL::uint16 latitude_seconds = 0, longitude_seconds = 0;
+			auto value = static_cast<AL::Double>(degrees) * FIXED_POINT_SCALE;
+
+			return static_cast<AL::int32>((value >= 0) ? (value + 0.5) : (value - 0.5));
+		}
 
-			// TODO: math
+		static AL::Float FromFixedPoint(AL::int32 value)
+		{
+			return static_cast<AL::Float>(static_cast<AL::Double>(value) / FIXED_POINT_SCALE);
+		}
 
+		Packet Encode(const AL::String& tocall, const AL::String& sender, const AL::String& digipath) const
+		{
 			Packet packet =
 			{
 				.ToCall   = tocall,
 				.Sender   = sender,
-				.Content  = AL::String::Format(
-					"!%i%02u.%02u%c%c%i%02u.%02u%c%c/A=%06li%s",
-					latitude_hours,
-					latitude_minutes,
-					latitude_seconds,
-					(latitude_hours >= 0) ? 'N' : 'S',
-					SymbolTable,
-					longitude_hours,
-					longitude_minutes,
-					longitude_seconds,
-					(longitude_hours >= 0) ? 'E' : 'W',
-					SymbolTableKey,
-					Altitude,
-					Comment.GetCString()
-				),
 				.DigiPath = digipath
 			};
 
+			EncodeContent(packet.Content);
+
 			return packet;
 		}
 
+		// Appends !DDMM.hhN/DDDMM.hhW$/A=aaaaaa<comment> to buffer
+		void EncodeContent(AL::String& buffer) const
+		{
+			AL::String::Char content[1 + COORDINATES_LENGTH + 10];
+
+			content[0] = '!';
+			EncodeCoordinates(&content[1], Latitude, Longitude, SymbolTable, SymbolTableKey);
+
+			auto lpAltitude = &content[1 + COORDINATES_LENGTH];
+			lpAltitude[0]   = '/';
+			lpAltitude[1]   = 'A';
+			lpAltitude[2]   = '=';
+
+			AL::size_t length = 1 + COORDINATES_LENGTH + 3;
+
+			if (Altitude < 0)
+			{
+				content[length++] = '-';
+				EncodeDigits(&content[length], static_cast<AL::uint32>(-static_cast<AL::int64>(Altitude)) % 1000000, 6);
+			}
+			else
+			{
+
+				EncodeDigits(&content[length], static_cast<AL::uint32>(Altitude) % 1000000, 6);
+			}
+
+			buffer.Append(content, length + 6);
+			buffer.Append(Comment);
+		}
+
+		static constexpr AL::size_t COORDINATES_LENGTH = 19;
+
+		// Reads DDMM.hhN<table>DDDMM.hhW<key> (COORDINATES_LENGTH bytes)
+		// @return false if malformed
+		static bool DecodeCoordinates(const AL::String::Char* lpBuffer, AL::Float& latitude, AL::Float& longitude, AL::String::Char& table, AL::String::Char& key)
+		{
+			auto decode = [](const AL::String::Char* lpBuffer, AL::size_t degreeDigits, AL::Float& value)
+			{
+				AL::uint32 degrees, minutes, hundredths;
+
+				if (!DecodeDigits(lpBuffer, degreeDigits, degrees) ||
+					!DecodeDigits(&lpBuffer[degreeDigits], 2, minutes) ||
+					(lpBuffer[degreeDigits + 2] != '.') ||
+					!DecodeDigits(&lpBuffer[degreeDigits + 3], 2, hundredths))
+				{
+
+					return false;
+				}
+
+				value = degrees + (minutes / 60.0f) + (hundredths / 6000.0f);
+
+				return true;
+			};
+
+			if (!decode(&lpBuffer[0], 2, latitude) || !decode(&lpBuffer[9], 3, longitude))
+			{
+
+				return false;
+			}
+
+			switch (lpBuffer[7])
+			{
+				case 'N': break;
+				case 'S': latitude = -latitude; break;
+				default:  return false;
+			}
+
+			switch (lpBuffer[17])
+			{
+				case 'E': break;
+				case 'W': longitude = -longitude; break;
+				default:  return false;
+			}
+
+			table = lpBuffer[8];
+			key   = lpBuffer[18];
+
+			return true;
+		}
+
+		// @return false if any character is not a digit
+		static bool DecodeDigits(const AL::String::Char* lpBuffer, AL::size_t count, AL::uint32& value)
+		{
+			value = 0;
+
+			for (AL::size_t i = 0; i < count; ++i)
+			{
+				if ((lpBuffer[i] < '0') || (lpBuffer[i] > '9'))
+				{
+
+					return false;
+				}
+
+				value = (value * 10) + (lpBuffer[i] - '0');
+			}
+
+			return true;
+		}
+
+
+		// Writes DDMM.hhN<table>DDDMM.hhW<key> (COORDINATES_LENGTH bytes)
+		static void EncodeCoordinates(AL::String::Char* lpBuffer, AL::Float latitude, AL::Float longitude, AL::String::Char table, AL::String::Char key)
+		{
+			auto encode = [](AL::String::Char* lpBuffer, AL::Float degrees, AL::size_t degreeDigits, AL::uint32 maxDegrees)
+			{
+				// hundredths of a minute
+				auto value = static_cast<AL::uint32>(((degrees < 0) ? -static_cast<AL::Double>(degrees) : static_cast<AL::Double>(degrees)) * 6000 + 0.5);
+
+				if (value > (maxDegrees * 6000))
+				{
+
+					value = maxDegrees * 6000;
+				}
+
+				EncodeDigits(lpBuffer, value / 6000, degreeDigits);
+				EncodeDigits(&lpBuffer[degreeDigits], (value % 6000) / 100, 2);
+				lpBuffer[degreeDigits + 2] = '.';
+				EncodeDigits(&lpBuffer[degreeDigits + 3], value % 100, 2);
+			};
+
+			encode(&lpBuffer[0], latitude, 2, 90);
+			lpBuffer[7]  = (latitude < 0) ? 'S' : 'N';
+			lpBuffer[8]  = table;
+			encode(&lpBuffer[9], longitude, 3, 180);
+			lpBuffer[17] = (longitude < 0) ? 'W' : 'E';
+			lpBuffer[18] = key;
+		}
+
+		static void EncodeDigits(AL::String::Char* lpBuffer, AL::uint32 value, AL::size_t count)
+		{
+			for (AL::size_t i = count; i > 0; --i, value /= 10)
+			{
+
+				lpBuffer[i - 1] = static_cast<AL::String::Char>('0' + (value % 10));
+			}
+		}
+
 		static bool Decode(Position& position, const Packet& packet)
 		{
 			// TODO: add support for ambiguity
@@ -250,798 +863,6149 @@ namespace APRS
 		}
 	};
 
-	namespace IS
+	struct Object
 	{
-		typedef AL::Function<void()>                                                   ClientOnMessageSentCallback;
+		// items (')') have a 3-9 character name and no timestamp, objects (';') a 9 character name and a timestamp
+		bool             IsItem  = false;
+		bool             IsAlive = true;
+
+		AL::String       Name;
+
+		// DHM zulu, all zero encodes the 111111z placeholder
+		AL::uint8        Day     = 0;
+		AL::uint8        Hour    = 0;
+		AL::uint8        Minute  = 0;
+
+		AL::Float        Latitude;
+		AL::Float        Longitude;
 
-		typedef AL::EventHandler<void()>                                               ClientOnConnectEventHandler;
-		typedef AL::EventHandler<void()>                                               ClientOnDisconnectEventHandler;
-		typedef AL::EventHandler<void(const Packet& packet)>                           ClientOnReceivePacketEventHandler;
-		typedef AL::EventHandler<void(const Packet& packet, const Message& message)>   ClientOnReceiveMessageEventHandler;
-		typedef AL::EventHandler<void(const Packet& packet, const Position& position)> ClientOnReceivePositionEventHandler;
+		AL::String       Comment;
+		AL::String::Char SymbolTable;
+		AL::String::Char SymbolTableKey;
+
+		// name and comment within Packet::Content, set by Decode instead of Name and Comment
+		AL::size_t       NameOffset    = 0;
+		AL::size_t       NameLength    = 0;
+		AL::size_t       CommentOffset = 0;
+		AL::size_t       CommentLength = 0;
 
-		class Client
+		AL::String GetName(const Packet& packet) const
 		{
-			class Connection
+			return AL::String(&packet.Content.GetCString()[NameOffset], NameLength);
+		}
+
+		AL::String GetComment(const Packet& packet) const
+		{
+			return AL::String(&packet.Content.GetCString()[CommentOffset], CommentLength);
+		}
+
+		Packet Encode(const AL::String& tocall, const AL::String& sender, const AL::String& digipath) const
+		{
+			Packet packet =
 			{
-				AL::Network::TcpSocket  socket;
-				AL::Network::IPEndPoint remoteEP;
+				.ToCall   = tocall,
+				.Sender   = sender,
+				.DigiPath = digipath
+			};
 
-			public:
-				explicit Connection(const AL::Network::IPEndPoint& remoteEP)
-					: socket(
-						remoteEP.Host.GetFamily()
-					),
-					remoteEP(
-						remoteEP
-					)
-				{
-				}
+			EncodeContent(packet.Content);
 
-				virtual ~Connection()
+			return packet;
+		}
+
+		// Appends ;NNNNNNNNN*DDHHMMz<coordinates><comment> or )NAME!<coordinates><comment> to buffer
+		void EncodeContent(AL::String& buffer) const
+		{
+			AL::String::Char content[1 + 9 + 1 + 7 + Position::COORDINATES_LENGTH];
+			AL::size_t       length     = 1;
+			AL::size_t       nameLength = (Name.GetLength() > 9) ? 9 : Name.GetLength();
+
+			content[0] = IsItem ? ')' : ';';
+			::memcpy(&content[length], Name.GetCString(), nameLength);
+			length += nameLength;
+
+			if (IsItem)
+			{
+				for (; nameLength < 3; ++nameLength)
 				{
-					if (IsOpen())
-					{
 
-						Close();
-					}
+					content[length++] = ' ';
 				}
 
-				bool IsBlocking() const
+				content[length++] = IsAlive ? '!' : '_';
+			}
+			else
+			{
+				for (; nameLength < 9; ++nameLength)
 				{
-					return socket.IsBlocking();
+
+					content[length++] = ' ';
 				}
 
-				bool IsOpen() const
+				content[length++] = IsAlive ? '*' : '_';
+
+				if ((Day == 0) && (Hour == 0) && (Minute == 0))
 				{
-					return socket.IsConnected();
+					::memcpy(&content[length], "111111", 6);
 				}
-
-				// @throw AL::Exception
-				void Open()
+				else
 				{
-					AL_ASSERT(
-						!IsOpen(),
-						"Connection already open"
-					);
+					Position::EncodeDigits(&content[length + 0], Day,    2);
+					Position::EncodeDigits(&content[length + 2], Hour,   2);
+					Position::EncodeDigits(&content[length + 4], Minute, 2);
+				}
 
-					try
-					{
-						socket.Open();
+				content[length + 6] = 'z';
+				length             += 7;
+			}
 
-						try
-						{
-							if (!socket.Connect(remoteEP))
-							{
+			Position::EncodeCoordinates(&content[length], Latitude, Longitude, SymbolTable, SymbolTableKey);
+			length += Position::COORDINATES_LENGTH;
 
-								throw AL::Exception(
-									"Connection timed out"
-								);
-							}
-						}
-						catch (AL::Exception&)
-						{
-							socket.Close();
+			buffer.Append(content, length);
+			buffer.Append(Comment);
+		}
 
-							throw;
-						}
-					}
-					catch (AL::Exception& exception)
-					{
+		// Name and Comment are left untouched, see GetName and GetComment
+		static bool Decode(Object& object, const Packet& packet)
+		{
+			auto lpContent = packet.Content.GetCString();
+			auto length    = packet.Content.GetLength();
 
-						throw AL::Exception(
-							"Error connecting to %s:%u",
-							remoteEP.Host.ToString().GetCString(),
-							remoteEP.Port
-						);
-					}
-				}
+			if (length == 0)
+			{
 
-				void Close()
-				{
-					socket.Close();
-				}
+				return false;
+			}
 
-				// @throw AL::Exception
-				void SetBlocking(bool value)
-				{
-					socket.SetBlocking(value);
-				}
+			AL::size_t offset;
 
-				// @throw AL::Exception
-				// @return 0 on connection closed
-				// @return -1 if would block
-				int ReadLine(AL::String& value, bool block)
+			switch (lpContent[0])
+			{
+				case ';':
 				{
-					AL_ASSERT(
-						IsConnected(),
-						"Connection not open"
-					);
+					// ;NNNNNNNNN*DDHHMMz
+					if ((length < (18 + Position::COORDINATES_LENGTH)) || ((lpContent[10] != '*') && (lpContent[10] != '_')))
+					{
 
-					value.Clear();
+						return false;
+					}
 
-					AL::String::Char buffer[2];
-					AL::size_t       numberOfBytesReceived;
+					AL::uint32 day, hour, minute;
 
-					auto buffer_Update = [&buffer]()
+					if (!Position::DecodeDigits(&lpContent[11], 2, day) ||
+						!Position::DecodeDigits(&lpContent[13], 2, hour) ||
+						!Position::DecodeDigits(&lpContent[15], 2, minute))
 					{
-						if ((buffer[0] == '\r') && (buffer[1] == '\n'))
-						{
 
-							return false;
-						}
-
-						buffer[0] = buffer[1];
+						return false;
+					}
 
-						return true;
-					};
+					object.IsItem  = false;
+					object.IsAlive = lpContent[10] == '*';
+					object.Day     = (lpContent[17] == 'z') ? static_cast<AL::uint8>(day)    : 0;
+					object.Hour    = (lpContent[17] == 'z') ? static_cast<AL::uint8>(hour)   : 0;
+					object.Minute  = (lpContent[17] == 'z') ? static_cast<AL::uint8>(minute) : 0;
 
-					if (!block)
+					// the 111111z placeholder decodes as no timestamp
+					if ((day == 11) && (hour == 11) && (minute == 11))
 					{
-						try
-						{
-							if (!AL::Network::SocketExtensions::TryReceiveAll(socket, &buffer[1], sizeof(buffer[1]), numberOfBytesReceived))
-							{
-								Close();
-
-								return 0;
-							}
-						}
-						catch (AL::Exception&)
-						{
-							Close();
+						object.Day    = 0;
+						object.Hour   = 0;
+						object.Minute = 0;
+					}
 
-							throw;
-						}
+					AL::size_t nameLength = 9;
 
-						if (numberOfBytesReceived == 0)
-						{
+					while ((nameLength != 0) && (lpContent[nameLength] == ' '))
+					{
 
-							return -1;
-						}
+						--nameLength;
+					}
 
-						value.Append(
-							buffer[1]
-						);
+					object.NameOffset = 1;
+					object.NameLength = nameLength;
+					offset            = 18;
+				}
+				break;
 
-						buffer_Update();
-					}
+				case ')':
+				{
+					// )NAME! or )NAME_ with a 3-9 character name
+					AL::size_t nameLength = 3;
 
-					do
+					for (; (nameLength <= 9) && ((1 + nameLength) < length); ++nameLength)
 					{
-						try
-						{
-							if (!AL::Network::SocketExtensions::ReceiveAll(socket, &buffer[1], sizeof(buffer[1]), numberOfBytesReceived))
-							{
-								Close();
-
-								return 0;
-							}
-						}
-						catch (AL::Exception&)
+						if ((lpContent[1 + nameLength] == '!') || (lpContent[1 + nameLength] == '_'))
 						{
-							Close();
 
-							throw;
+							break;
 						}
+					}
 
-						value.Append(
-							buffer[1]
-						);
-					} while (buffer_Update());
+					if ((nameLength > 9) || ((2 + nameLength + Position::COORDINATES_LENGTH) > length))
+					{
 
-					value.Erase(
-						value.GetLength() - 2,
-						2
-					);
+						return false;
+					}
 
-					return 1;
+					object.IsItem     = true;
+					object.IsAlive    = lpContent[1 + nameLength] == '!';
+					object.Day        = 0;
+					object.Hour       = 0;
+					object.Minute     = 0;
+					object.NameOffset = 1;
+					object.NameLength = nameLength;
+					offset            = 2 + nameLength;
 				}
+				break;
 
-				// @throw AL::Exception
-				// @return false on connection closed
-				bool WriteLine(const AL::String& value)
-				{
-					AL_ASSERT(
-						IsConnected(),
-						"Connection not open"
-					);
+				default:
+					return false;
+			}
 
-					auto valueLength = value.GetLength();
+			if (!Position::DecodeCoordinates(&lpContent[offset], object.Latitude, object.Longitude, object.SymbolTable, object.SymbolTableKey))
+			{
+
+				return false;
+			}
+
+			offset              += Position::COORDINATES_LENGTH;
+			object.CommentOffset = offset;
+			object.CommentLength = length - offset;
+
+			return true;
+		}
+	};
+
+	struct Weather
+	{
+		enum FieldTypes : AL::uint16
+		{
+			FIELD_WIND_DIRECTION      = 0x0001,
+			FIELD_WIND_SPEED          = 0x0002,
+			FIELD_WIND_GUST           = 0x0004,
+			FIELD_TEMPERATURE         = 0x0008,
+			FIELD_RAIN_LAST_HOUR      = 0x0010,
+			FIELD_RAIN_LAST_24_HOURS  = 0x0020,
+			FIELD_RAIN_SINCE_MIDNIGHT = 0x0040,
+			FIELD_HUMIDITY            = 0x0080,
+			FIELD_PRESSURE            = 0x0100,
+			FIELD_LUMINOSITY          = 0x0200
+		};
+
+		// FIELD_* present in the report
+		AL::uint16 Fields;
+
+		// degrees
+		AL::uint16 WindDirection;
+		// mph
+		AL::uint16 WindSpeed;
+		// mph
+		AL::uint16 WindGust;
+		// fahrenheit
+		AL::int16  Temperature;
+		// hundredths of an inch
+		AL::uint16 RainLastHour;
+		// hundredths of an inch
+		AL::uint16 RainLast24Hours;
+		// hundredths of an inch
+		AL::uint16 RainSinceMidnight;
+		// percent
+		AL::uint8  Humidity;
+		// tenths of a millibar
+		AL::uint32 Pressure;
+		// watts per square meter
+		AL::uint16 Luminosity;
+
+		bool IsSet(FieldTypes field) const
+		{
+			return (Fields & field) != 0;
+		}
+
+		// Decodes a positionless report: _MMDDHHMM<fields>
+		static bool Decode(Weather& weather, const Packet& packet)
+		{
+			auto lpContent = packet.Content.GetCString();
+			auto length    = packet.Content.GetLength();
+
+			AL::uint32 timestamp;
+
+			if ((length < 9) || (lpContent[0] != '_') || !Position::DecodeDigits(&lpContent[1], 8, timestamp))
+			{
+
+				return false;
+			}
+
+			weather.Fields = 0;
+			DecodeFields(weather, &lpContent[9], length - 9);
+
+			return true;
+		}
+		// Decodes the weather data following a position with the weather station symbol: DDD/SSS<fields>
+		static bool Decode(Weather& weather, const Position& position)
+		{
+			auto lpComment = position.Comment.GetCString();
+			auto length    = position.Comment.GetLength();
+
+			if ((position.SymbolTableKey != '_') || (length < 7) || (lpComment[3] != '/'))
+			{
+
+				return false;
+			}
+
+			weather.Fields = 0;
+
+			if (DecodeField(weather, FIELD_WIND_DIRECTION, &lpComment[0], 3) < 0 ||
+				DecodeField(weather, FIELD_WIND_SPEED, &lpComment[4], 3) < 0)
+			{
+
+				return false;
+			}
+
+			DecodeFields(weather, &lpComment[7], length - 7);
+
+			return true;
+		}
+
+	private:
+		static void DecodeFields(Weather& weather, const AL::String::Char* lpBuffer, AL::size_t size)
+		{
+			// stops at the first unknown field, the remainder is software type and comment
+			for (AL::size_t offset = 0; offset < size; )
+			{
+				FieldTypes field;
+				AL::size_t digits;
+				AL::uint32 offsetValue = 0;
+
+				switch (lpBuffer[offset])
+				{
+					case 'c': field = FIELD_WIND_DIRECTION;      digits = 3; break;
+					case 's': field = FIELD_WIND_SPEED;          digits = 3; break;
+					case 'g': field = FIELD_WIND_GUST;           digits = 3; break;
+					case 't': field = FIELD_TEMPERATURE;         digits = 3; break;
+					case 'r': field = FIELD_RAIN_LAST_HOUR;      digits = 3; break;
+					case 'p': field = FIELD_RAIN_LAST_24_HOURS;  digits = 3; break;
+					case 'P': field = FIELD_RAIN_SINCE_MIDNIGHT; digits = 3; break;
+					case 'h': field = FIELD_HUMIDITY;            digits = 2; break;
+					case 'b': field = FIELD_PRESSURE;            digits = 5; break;
+					case 'L': field = FIELD_LUMINOSITY;          digits = 3; break;
+					case 'l': field = FIELD_LUMINOSITY;          digits = 3; offsetValue = 1000; break;
+					default:  return;
+				}
+
+				if (((offset + 1 + digits) > size) || (DecodeField(weather, field, &lpBuffer[offset + 1], digits, offsetValue) < 0))
+				{
+
+					return;
+				}
+
+				offset += 1 + digits;
+			}
+		}
+
+		// @return -1 if malformed
+		// @return 0 if not reported (padded with '.' or ' ')
+		static int DecodeField(Weather& weather, FieldTypes field, const AL::String::Char* lpBuffer, AL::size_t digits, AL::uint32 offsetValue = 0)
+		{
+			bool       isNegative = false;
+			AL::uint32 value      = 0;
+
+			for (AL::size_t i = 0; i < digits; ++i)
+			{
+				auto c = lpBuffer[i];
+
+				if ((c >= '0') && (c <= '9'))
+				{
+					value = (value * 10) + (c - '0');
+				}
+				else if ((c == '-') && (i == 0) && (field == FIELD_TEMPERATURE))
+				{
+					isNegative = true;
+				}
+				else if ((c == '.') || (c == ' '))
+				{
+					for (; i < digits; ++i)
+					{
+						if ((lpBuffer[i] != '.') && (lpBuffer[i] != ' '))
+						{
+
+							return -1;
+						}
+					}
+
+					return 0;
+				}
+				else
+				{
+
+					return -1;
+				}
+			}
+
+			value += offsetValue;
+
+			switch (field)
+			{
+				case FIELD_WIND_DIRECTION:      weather.WindDirection     = static_cast<AL::uint16>(value); break;
+				case FIELD_WIND_SPEED:          weather.WindSpeed         = static_cast<AL::uint16>(value); break;
+				case FIELD_WIND_GUST:           weather.WindGust          = static_cast<AL::uint16>(value); break;
+				case FIELD_TEMPERATURE:         weather.Temperature       = static_cast<AL::int16>(isNegative ? -static_cast<AL::int32>(value) : static_cast<AL::int32>(value)); break;
+				case FIELD_RAIN_LAST_HOUR:      weather.RainLastHour      = static_cast<AL::uint16>(value); break;
+				case FIELD_RAIN_LAST_24_HOURS:  weather.RainLast24Hours   = static_cast<AL::uint16>(value); break;
+				case FIELD_RAIN_SINCE_MIDNIGHT: weather.RainSinceMidnight = static_cast<AL::uint16>(value); break;
+				case FIELD_HUMIDITY:            weather.Humidity          = static_cast<AL::uint8>((value == 0) ? 100 : value); break;
+				case FIELD_PRESSURE:            weather.Pressure          = value; break;
+				case FIELD_LUMINOSITY:          weather.Luminosity        = static_cast<AL::uint16>(value); break;
+			}
+
+			weather.Fields |= field;
+
+			return 1;
+		}
+	};
+
+	struct Telemetry
+	{
+		static constexpr AL::size_t ANALOG_COUNT = 5;
+
+		// 0 if the sequence is not numeric (e.g. MIC)
+		AL::uint16 Sequence;
+		// number of analog values reported
+		AL::uint8  AnalogCount;
+		AL::Float  Analog[ANALOG_COUNT];
+		// bit 7 is the first digital value
+		AL::uint8  Digital;
+
+		// T#sss,aaa,aaa,aaa,aaa,aaa,bbbbbbbb or T#MICaaa,...
+		static bool Decode(Telemetry& telemetry, const Packet& packet)
+		{
+			auto lpContent = packet.Content.GetCString();
+			auto length    = packet.Content.GetLength();
+
+			if ((length < 3) || (lpContent[0] != 'T') || (lpContent[1] != '#'))
+			{
+
+				return false;
+			}
+
+			AL::size_t offset = 2;
+			auto       next   = [&]()
+			{
+				auto begin = offset;
+
+				while ((offset < length) && (lpContent[offset] != ','))
+				{
+
+					++offset;
+				}
+
+				auto end = offset;
+
+				if (offset < length)
+				{
+
+					++offset;
+				}
+
+				return end - begin;
+			};
+
+			if (((offset + 3) <= length) && (::memcmp(&lpContent[offset], "MIC", 3) == 0))
+			{
+				// T#MIC is optionally followed by a comma
+				offset            += ((offset + 3) < length) && (lpContent[offset + 3] == ',') ? 4 : 3;
+				telemetry.Sequence = 0;
+			}
+			else
+			{
+				auto       begin = offset;
+				auto       size  = next();
+				AL::uint32 sequence;
+
+				telemetry.Sequence = Position::DecodeDigits(&lpContent[begin], size, sequence) ? static_cast<AL::uint16>(sequence) : 0;
+			}
+
+			telemetry.AnalogCount = 0;
+			telemetry.Digital     = 0;
+
+			while ((offset < length) && (telemetry.AnalogCount < ANALOG_COUNT))
+			{
+				auto begin = offset;
+				auto size  = next();
+
+				if (!DecodeFloat(&lpContent[begin], size, telemetry.Analog[telemetry.AnalogCount]))
+				{
+
+					return false;
+				}
+
+				++telemetry.AnalogCount;
+			}
+
+			if ((offset + 8) <= length)
+			{
+				for (AL::size_t i = 0; i < 8; ++i)
+				{
+					switch (lpContent[offset + i])
+					{
+						case '0': break;
+						case '1': telemetry.Digital |= 0x80 >> i; break;
+						default:  return false;
+					}
+				}
+			}
+
+			return telemetry.AnalogCount != 0;
+		}
+
+	private:
+		static bool DecodeFloat(const AL::String::Char* lpBuffer, AL::size_t size, AL::Float& value)
+		{
+			bool       isNegative = false;
+			bool       isFraction = false;
+			bool       hasDigits  = false;
+			AL::Double result     = 0;
+			AL::Double scale      = 1;
+
+			for (AL::size_t i = 0; i < size; ++i)
+			{
+				auto c = lpBuffer[i];
+
+				if ((c >= '0') && (c <= '9'))
+				{
+					hasDigits = true;
+
+					if (isFraction)
+						result += (c - '0') * (scale /= 10);
+					else
+						result = (result * 10) + (c - '0');
+				}
+				else if ((c == '-') && (i == 0))
+					isNegative = true;
+				else if ((c == '.') && !isFraction)
+					isFraction = true;
+				else
+					return false;
+			}
+
+			value = static_cast<AL::Float>(isNegative ? -result : result);
+
+			return hasDigits;
+		}
+	};
+
+	struct Status
+	{
+		// DHM zulu, all zero if not reported
+		AL::uint8  Day;
+		AL::uint8  Hour;
+		AL::uint8  Minute;
+
+		// status text within Packet::Content
+		AL::size_t TextOffset;
+		AL::size_t TextLength;
+
+		AL::String GetText(const Packet& packet) const
+		{
+			return AL::String(&packet.Content.GetCString()[TextOffset], TextLength);
+		}
+
+		// >[DDHHMMz]text
+		static bool Decode(Status& status, const Packet& packet)
+		{
+			auto lpContent = packet.Content.GetCString();
+			auto length    = packet.Content.GetLength();
+
+			if ((length == 0) || (lpContent[0] != '>'))
+			{
+
+				return false;
+			}
+
+			AL::uint32 day, hour, minute;
+
+			status.Day        = 0;
+			status.Hour       = 0;
+			status.Minute     = 0;
+			status.TextOffset = 1;
+
+			if ((length >= 8) && (lpContent[7] == 'z') &&
+				Position::DecodeDigits(&lpContent[1], 2, day) &&
+				Position::DecodeDigits(&lpContent[3], 2, hour) &&
+				Position::DecodeDigits(&lpContent[5], 2, minute))
+			{
+				status.Day        = static_cast<AL::uint8>(day);
+				status.Hour       = static_cast<AL::uint8>(hour);
+				status.Minute     = static_cast<AL::uint8>(minute);
+				status.TextOffset = 8;
+			}
+
+			status.TextLength = length - status.TextOffset;
+
+			return true;
+		}
+	};
+
+	// Encodes many packets from one sender into one contiguous buffer of CRLF terminated lines
+	class PacketBatchEncoder
+	{
+		AL::String buffer;
+		AL::String header;
+		AL::size_t count = 0;
+
+	public:
+		// longer lines are truncated, as by Connection::WriteLine
+		static constexpr AL::size_t MAX_LINE_LENGTH = 510;
+
+		PacketBatchEncoder(const AL::String& tocall, const AL::String& sender, const AL::String& digipath)
+		{
+			header.Append(sender);
+			header.Append('>');
+			header.Append(tocall);
+
+			if (digipath.GetLength() != 0)
+			{
+				header.Append(',');
+				header.Append(digipath);
+			}
+
+			header.Append(':');
+		}
+
+		auto& GetBuffer() const
+		{
+			return buffer;
+		}
+
+		auto GetCount() const
+		{
+			return count;
+		}
+
+		void Clear()
+		{
+			buffer.Clear();
+			count = 0;
+		}
+
+		// T must provide void EncodeContent(AL::String&) const (Position, Object)
+		template<typename T>
+		void Append(const T& value)
+		{
+			auto lineStart = buffer.GetLength();
+
+			buffer.Append(header);
+			value.EncodeContent(buffer);
+
+			if (auto lineLength = buffer.GetLength() - lineStart; lineLength > MAX_LINE_LENGTH)
+			{
+
+				buffer.Erase(lineStart + MAX_LINE_LENGTH, lineLength - MAX_LINE_LENGTH);
+			}
+
+			buffer.Append("\r\n", 2);
+
+			++count;
+		}
+
+		void Append(const Packet& packet)
+		{
+			auto line = packet.Encode();
+
+			buffer.Append(line.GetCString(), (line.GetLength() > MAX_LINE_LENGTH) ? MAX_LINE_LENGTH : line.GetLength());
+			buffer.Append("\r\n", 2);
+
+			++count;
+		}
+	};
+
+	// Spreads beacons evenly over an interval instead of sending them in one burst
+	// Entry i of n is due at (i * interval / n) into every cycle. A beacon more than one
+	// slot (interval / n) overdue re-anchors the cycle on itself, so after a stall the
+	// schedule resumes at the normal spacing instead of catching up.
+	template<typename T>
+	class BeaconScheduler
+	{
+		AL::Collections::ArrayList<T> beacons;
+		AL::TimeSpan                  interval;
+
+		AL::size_t                    next       = 0;
+		bool                          isStarted  = false;
+		AL::uint64                    cycleStart = 0;
+
+	public:
+		explicit BeaconScheduler(AL::TimeSpan interval)
+			: interval(
+				interval
+			)
+		{
+		}
+
+		AL::size_t GetSize() const
+		{
+			return beacons.GetSize();
+		}
+
+		auto GetInterval() const
+		{
+			return interval;
+		}
+
+		T& Get(AL::size_t index)
+		{
+			return beacons[index];
+		}
+		const T& Get(AL::size_t index) const
+		{
+			return beacons[index];
+		}
+
+		void Add(T&& value)
+		{
+			beacons.PushBack(AL::Move(value));
+		}
+		void Add(const T& value)
+		{
+			beacons.PushBack(value);
+		}
+
+		void Remove(AL::size_t index)
+		{
+			beacons.RemoveAt(index);
+
+			if (next > index)
+			{
+
+				--next;
+			}
+		}
+
+		void Clear()
+		{
+			beacons.Clear();
+			next = 0;
+		}
+
+		// @param now monotonic time (e.g. AL::OS::Timer::GetElapsed)
+		// @return number of beacons appended to batch
+		AL::size_t Poll(AL::TimeSpan now, PacketBatchEncoder& batch)
+		{
+			auto time  = now.ToMicroseconds();
+			auto count = beacons.GetSize();
+
+			if (count == 0)
+			{
+
+				return 0;
+			}
+
+			if (!isStarted)
+			{
+				isStarted  = true;
+				cycleStart = time;
+			}
+
+			auto       cycle = interval.ToMicroseconds();
+			auto       slot  = cycle / count;
+			AL::size_t sent  = 0;
+
+			if (next >= count)
+			{
+
+				next = 0;
+			}
+
+			// only entries within one slot of their due time are sent, a stalled caller
+			// gets the first overdue entry and the rest keep their spacing after it
+			while (sent < count)
+			{
+				auto offset = (next * cycle) / count;
+
+				if ((cycleStart + offset) > time)
+				{
+
+					break;
+				}
+
+				if ((time - (cycleStart + offset)) > slot)
+				{
+
+					cycleStart = time - offset;
+				}
+
+				batch.Append(beacons[next]);
+				++sent;
+
+				if (++next == count)
+				{
+					next        = 0;
+					cycleStart += cycle;
+				}
+			}
+
+			return sent;
+		}
+	};
+
+	// Decodes the sub-structures of a packet on first access and caches the result
+	class LazyPacket
+	{
+		enum _Flags : AL::uint8
+		{
+			_FLAG_OBJECT    = 0x01,
+			_FLAG_STATUS    = 0x02,
+			_FLAG_MESSAGE   = 0x04,
+			_FLAG_WEATHER   = 0x08,
+			_FLAG_POSITION  = 0x10,
+			_FLAG_TELEMETRY = 0x20
+		};
+
+		const Packet* lpPacket;
+
+		AL::uint8     decoded = 0;
+		AL::uint8     valid   = 0;
+
+		Object        object;
+		Status        status;
+		Message       message;
+		Weather       weather;
+		Position      position;
+		Telemetry     telemetry;
+
+	public:
+		explicit LazyPacket(const Packet& packet)
+			: lpPacket(
+				&packet
+			)
+		{
+		}
+
+		auto& GetPacket() const
+		{
+			return *lpPacket;
+		}
+
+		// @return nullptr if not a message or decoding failed
+		const Message* GetMessage()
+		{
+			if (!(decoded & _FLAG_MESSAGE))
+			{
+				decoded |= _FLAG_MESSAGE;
+
+				if (lpPacket->IsMessage() && Message::Decode(message, *lpPacket))
+				{
+
+					valid |= _FLAG_MESSAGE;
+				}
+			}
+
+			return (valid & _FLAG_MESSAGE) ? &message : nullptr;
+		}
+
+		// @return nullptr if not a position or decoding failed
+		const Position* GetPosition()
+		{
+			if (!(decoded & _FLAG_POSITION))
+			{
+				decoded |= _FLAG_POSITION;
+
+				if (lpPacket->IsPosition() && Position::Decode(position, *lpPacket))
+				{
+
+					valid |= _FLAG_POSITION;
+				}
+			}
+
+			return (valid & _FLAG_POSITION) ? &position : nullptr;
+		}
+
+		// @return nullptr if not an object/item or decoding failed
+		const Object* GetObject()
+		{
+			if (!(decoded & _FLAG_OBJECT))
+			{
+				decoded |= _FLAG_OBJECT;
+
+				if (Object::Decode(object, *lpPacket))
+				{
+
+					valid |= _FLAG_OBJECT;
+				}
+			}
+
+			return (valid & _FLAG_OBJECT) ? &object : nullptr;
+		}
+
+		// @return nullptr if not a status or decoding failed
+		const Status* GetStatus()
+		{
+			if (!(decoded & _FLAG_STATUS))
+			{
+				decoded |= _FLAG_STATUS;
+
+				if (Status::Decode(status, *lpPacket))
+				{
+
+					valid |= _FLAG_STATUS;
+				}
+			}
+
+			return (valid & _FLAG_STATUS) ? &status : nullptr;
+		}
+
+		// Note: includes positions with the weather station symbol
+		// @return nullptr if not a weather report or decoding failed
+		const Weather* GetWeather()
+		{
+			if (!(decoded & _FLAG_WEATHER))
+			{
+				decoded |= _FLAG_WEATHER;
+
+				if (Weather::Decode(weather, *lpPacket))
+				{
+
+					valid |= _FLAG_WEATHER;
+				}
+				else if (auto lpPosition = GetPosition(); (lpPosition != nullptr) && Weather::Decode(weather, *lpPosition))
+				{
+
+					valid |= _FLAG_WEATHER;
+				}
+			}
+
+			return (valid & _FLAG_WEATHER) ? &weather : nullptr;
+		}
+
+		// @return nullptr if not telemetry or decoding failed
+		const Telemetry* GetTelemetry()
+		{
+			if (!(decoded & _FLAG_TELEMETRY))
+			{
+				decoded |= _FLAG_TELEMETRY;
+
+				if (Telemetry::Decode(telemetry, *lpPacket))
+				{
+
+					valid |= _FLAG_TELEMETRY;
+				}
+			}
+
+			return (valid & _FLAG_TELEMETRY) ? &telemetry : nullptr;
+		}
+	};
+
+	// Interns callsigns and other short header fields into dense 32-bit ids
+	class CallsignTable
+	{
+		AL::Collections::Array<AL::uint32>     slots;
+		AL::Collections::ArrayList<AL::String> values;
+		AL::Collections::ArrayList<AL::uint32> hashes;
+
+	public:
+		static constexpr AL::uint32 INVALID_ID = 0xFFFFFFFF;
+
+		CallsignTable()
+			: slots(
+				16
+			)
+		{
+			for (auto& slot : slots)
+			{
+
+				slot = 0;
+			}
+		}
+
+		AL::size_t GetSize() const
+		{
+			return values.GetSize();
+		}
+
+		const AL::String& Get(AL::uint32 id) const
+		{
+			AL_ASSERT(
+				id < GetSize(),
+				"Invalid id"
+			);
+
+			return values[id];
+		}
+
+		// @return INVALID_ID if not found
+		AL::uint32 Find(const AL::String& value) const
+		{
+			return Find(value.GetCString(), value.GetLength());
+		}
+		// @return INVALID_ID if not found
+		AL::uint32 Find(const AL::String::Char* lpValue, AL::size_t length) const
+		{
+			auto hash = Hash(lpValue, length);
+			auto mask = slots.GetSize() - 1;
+
+			for (auto i = hash & mask; ; i = (i + 1) & mask)
+			{
+				if (slots[i] == 0)
+				{
+
+					return INVALID_ID;
+				}
+
+				auto id = slots[i] - 1;
+
+				if ((hashes[id] == hash) && Equals(values[id], lpValue, length))
+				{
+
+					return id;
+				}
+			}
+		}
+
+		AL::uint32 Intern(const AL::String& value)
+		{
+			return Intern(value.GetCString(), value.GetLength());
+		}
+		AL::uint32 Intern(const AL::String::Char* lpValue, AL::size_t length)
+		{
+			auto hash = Hash(lpValue, length);
+			auto mask = slots.GetSize() - 1;
+			auto i    = hash & mask;
+
+			for (; slots[i] != 0; i = (i + 1) & mask)
+			{
+				auto id = slots[i] - 1;
+
+				if ((hashes[id] == hash) && Equals(values[id], lpValue, length))
+				{
+
+					return id;
+				}
+			}
+
+			AL::uint32 id = static_cast<AL::uint32>(values.GetSize());
+
+			values.PushBack(AL::String(lpValue, length));
+			hashes.PushBack(hash);
+
+			if (((values.GetSize() * 4) / 3) >= slots.GetSize())
+				Rehash(slots.GetSize() * 2);
+			else
+				slots[i] = id + 1;
+
+			return id;
+		}
+
+		void Clear()
+		{
+			values.Clear();
+			hashes.Clear();
+
+			for (auto& slot : slots)
+			{
+
+				slot = 0;
+			}
+		}
+
+		static AL::uint32 Hash(const AL::String::Char* lpValue, AL::size_t length)
+		{
+			// FNV-1a
+			AL::uint32 hash = 2166136261;
+
+			for (AL::size_t i = 0; i < length; ++i)
+			{
+				hash ^= static_cast<AL::uint8>(lpValue[i]);
+				hash *= 16777619;
+			}
+
+			return hash;
+		}
+
+	private:
+		void Rehash(AL::size_t capacity)
+		{
+			AL::Collections::Array<AL::uint32> slots(capacity);
+
+			for (auto& slot : slots)
+			{
+
+				slot = 0;
+			}
+
+			auto mask = capacity - 1;
+
+			for (AL::size_t id = 0; id < values.GetSize(); ++id)
+			{
+				auto i = hashes[id] & mask;
+
+				while (slots[i] != 0)
+				{
+
+					i = (i + 1) & mask;
+				}
+
+				slots[i] = static_cast<AL::uint32>(id + 1);
+			}
+
+			this->slots = AL::Move(slots);
+		}
+
+		static bool Equals(const AL::String& value, const AL::String::Char* lpValue, AL::size_t length)
+		{
+			return (value.GetLength() == length) && (::memcmp(value.GetCString(), lpValue, length) == 0);
+		}
+	};
+
+	// Open addressing map from non-zero 64-bit keys to T with linear probing
+	// Removal uses backward shift deletion so probe sequences never walk tombstones.
+	template<typename T>
+	class FlatMap
+	{
+		struct _Slot
+		{
+			// 0 if empty
+			AL::uint64 Key;
+			T          Value;
+		};
+
+		AL::Collections::Array<_Slot> slots;
+		AL::size_t                    size = 0;
+
+	public:
+		FlatMap()
+			: slots(
+				16
+			)
+		{
+			for (auto& slot : slots)
+			{
+
+				slot.Key = 0;
+			}
+		}
+
+		AL::size_t GetSize() const
+		{
+			return size;
+		}
+
+		// @return nullptr if not found
+		T* Find(AL::uint64 key)
+		{
+			auto mask = slots.GetSize() - 1;
+
+			for (auto i = Hash(key) & mask; slots[i].Key != 0; i = (i + 1) & mask)
+			{
+				if (slots[i].Key == key)
+				{
+
+					return &slots[i].Value;
+				}
+			}
+
+			return nullptr;
+		}
+		// @return nullptr if not found
+		const T* Find(AL::uint64 key) const
+		{
+			return const_cast<FlatMap*>(this)->Find(key);
+		}
+
+		// @param key must not be 0
+		// @return existing or default constructed value
+		T& Insert(AL::uint64 key)
+		{
+			AL_ASSERT(
+				key != 0,
+				"Invalid key"
+			);
+
+			if (((size + 1) * 4) >= (slots.GetSize() * 3))
+			{
+
+				Rehash(slots.GetSize() * 2);
+			}
+
+			auto mask = slots.GetSize() - 1;
+			auto i    = Hash(key) & mask;
+
+			for (; slots[i].Key != 0; i = (i + 1) & mask)
+			{
+				if (slots[i].Key == key)
+				{
+
+					return slots[i].Value;
+				}
+			}
+
+			slots[i].Key   = key;
+			slots[i].Value = T();
+			++size;
+
+			return slots[i].Value;
+		}
+
+		// @return false if not found
+		bool Remove(AL::uint64 key)
+		{
+			auto mask = slots.GetSize() - 1;
+			auto i    = Hash(key) & mask;
+
+			while (slots[i].Key != key)
+			{
+				if (slots[i].Key == 0)
+				{
+
+					return false;
+				}
+
+				i = (i + 1) & mask;
+			}
+
+			for (auto j = (i + 1) & mask; slots[j].Key != 0; j = (j + 1) & mask)
+			{
+				auto home = Hash(slots[j].Key) & mask;
+
+				if (((j - home) & mask) >= ((j - i) & mask))
+				{
+					slots[i] = AL::Move(slots[j]);
+					i        = j;
+				}
+			}
+
+			slots[i].Key   = 0;
+			slots[i].Value = T();
+			--size;
+
+			return true;
+		}
+
+		// Calls callback(key, value) for every entry in unspecified order
+		// Note: the map must not be modified by callback
+		template<typename F>
+		void ForEach(F&& callback) const
+		{
+			for (auto& slot : slots)
+			{
+				if (slot.Key != 0)
+				{
+
+					callback(slot.Key, slot.Value);
+				}
+			}
+		}
+
+		void Clear()
+		{
+			if (size == 0)
+			{
+
+				return;
+			}
+
+			for (auto& slot : slots)
+			{
+				slot.Key   = 0;
+				slot.Value = T();
+			}
+
+			size = 0;
+		}
+
+		static AL::uint64 Hash(AL::uint64 key)
+		{
+			key ^= key >> 33;
+			key *= 0xFF51AFD7ED558CCD;
+			key ^= key >> 33;
+
+			return key;
+		}
+
+	private:
+		void Rehash(AL::size_t capacity)
+		{
+			AL::Collections::Array<_Slot> slots(capacity);
+
+			for (auto& slot : slots)
+			{
+
+				slot.Key = 0;
+			}
+
+			auto mask = capacity - 1;
+
+			for (auto& slot : this->slots)
+			{
+				if (slot.Key != 0)
+				{
+					auto i = Hash(slot.Key) & mask;
+
+					while (slots[i].Key != 0)
+					{
+
+						i = (i + 1) & mask;
+					}
+
+					slots[i] = AL::Move(slot);
+				}
+			}
+
+			this->slots = AL::Move(slots);
+		}
+	};
+
+	// Per-station state in structure-of-arrays form indexed by interned callsign id
+	// Each station costs 37 bytes plus its callsign, so aggregations stream through contiguous arrays
+	// instead of chasing nodes. Positions are read with Position::DecodeCoordinates and do not allocate.
+	class StationStore
+	{
+		CallsignTable                          callsigns;
+		CallsignTable                          igates;
+
+		AL::Collections::ArrayList<AL::uint64> lastHeard;
+		AL::Collections::ArrayList<AL::uint32> packetCount;
+		AL::Collections::ArrayList<AL::uint32> lastIGate;
+		AL::Collections::ArrayList<AL::uint64> lastPositionTime;
+		AL::Collections::ArrayList<AL::int32>  latitude;
+		AL::Collections::ArrayList<AL::int32>  longitude;
+		AL::Collections::ArrayList<AL::uint32> positionCount;
+		AL::Collections::ArrayList<AL::uint8>  symbol;
+
+	public:
+		// @return number of stations
+		AL::size_t GetSize() const
+		{
+			return callsigns.GetSize();
+		}
+
+		// @return CallsignTable::INVALID_ID if not found
+		AL::uint32 Find(const AL::String& callsign) const
+		{
+			return callsigns.Find(callsign);
+		}
+
+		auto& GetCallsigns() const
+		{
+			return callsigns;
+		}
+
+		// names indexed by GetLastIGate
+		auto& GetIGates() const
+		{
+			return igates;
+		}
+
+		auto& GetLastHeard() const
+		{
+			return lastHeard;
+		}
+
+		auto& GetPacketCount() const
+		{
+			return packetCount;
+		}
+
+		// id in GetIGates
+		auto& GetLastIGate() const
+		{
+			return lastIGate;
+		}
+
+		// only valid if HasPosition
+		auto& GetLastPositionTime() const
+		{
+			return lastPositionTime;
+		}
+
+		// fixed-point (see Position::FIXED_POINT_SCALE)
+		auto& GetLatitude() const
+		{
+			return latitude;
+		}
+
+		// fixed-point (see Position::FIXED_POINT_SCALE)
+		auto& GetLongitude() const
+		{
+			return longitude;
+		}
+
+		auto& GetPositionCount() const
+		{
+			return positionCount;
+		}
+
+		bool HasPosition(AL::uint32 id) const
+		{
+			return positionCount[id] != 0;
+		}
+
+		// @return symbol table key of the last position, 0 if none
+		AL::String::Char GetSymbol(AL::uint32 id) const
+		{
+			return static_cast<AL::String::Char>(symbol[id]);
+		}
+
+		// Records packet from its sender and updates the last position from '!' and '=' reports
+		// @param timestamp any clock, stations keep the newest timestamp when packets arrive out of order
+		// @return station id
+		AL::uint32 Update(AL::uint64 timestamp, const Packet& packet)
+		{
+			auto id = callsigns.Intern(packet.Sender);
+
+			if (id == lastHeard.GetSize())
+			{
+				lastHeard.PushBack(0);
+				packetCount.PushBack(0);
+				lastIGate.PushBack(CallsignTable::INVALID_ID);
+				lastPositionTime.PushBack(0);
+				latitude.PushBack(0);
+				longitude.PushBack(0);
+				positionCount.PushBack(0);
+				symbol.PushBack(0);
+			}
+
+			// packetCount is 0 until the station is first heard
+			if ((packetCount[id] == 0) || (timestamp > lastHeard[id]))
+			{
+
+				lastHeard[id] = timestamp;
+			}
+
+			++packetCount[id];
+			lastIGate[id] = igates.Intern(packet.IGate);
+
+			auto lpContent     = packet.Content.GetCString();
+			auto contentLength = packet.Content.GetLength();
+
+			if ((contentLength > Position::COORDINATES_LENGTH) && ((lpContent[0] == '!') || (lpContent[0] == '=')))
+			{
+				AL::Float        latitude, longitude;
+				AL::String::Char table, key;
+
+				if (Position::DecodeCoordinates(&lpContent[1], latitude, longitude, table, key))
+				{
+					bool isLatest = !HasPosition(id) || (timestamp >= lastPositionTime[id]);
+
+					++positionCount[id];
+
+					if (isLatest)
+					{
+						lastPositionTime[id] = timestamp;
+						this->latitude[id]   = Position::ToFixedPoint(latitude);
+						this->longitude[id]  = Position::ToFixedPoint(longitude);
+						symbol[id]           = static_cast<AL::uint8>(key);
+					}
+				}
+			}
+
+			return id;
+		}
+
+		// @return number of stations heard at or after timestamp
+		AL::size_t CountHeardSince(AL::uint64 timestamp) const
+		{
+			AL::size_t count = 0;
+
+			for (AL::size_t i = 0; i < lastHeard.GetSize(); ++i)
+			{
+
+				count += (lastHeard[i] >= timestamp) ? 1 : 0;
+			}
+
+			return count;
+		}
+
+		// Calls callback(id) for every station whose last position lies within the fixed-point bounds (inclusive)
+		// @return number of stations within the bounds
+		template<typename F>
+		AL::size_t ForEachInBounds(AL::int32 minLatitude, AL::int32 minLongitude, AL::int32 maxLatitude, AL::int32 maxLongitude, F&& callback) const
+		{
+			AL::size_t count = 0;
+
+			for (AL::uint32 id = 0; id < latitude.GetSize(); ++id)
+			{
+				if ((positionCount[id] != 0) &&
+					(latitude[id] >= minLatitude) && (latitude[id] <= maxLatitude) &&
+					(longitude[id] >= minLongitude) && (longitude[id] <= maxLongitude))
+				{
+					callback(id);
+
+					++count;
+				}
+			}
+
+			return count;
+		}
+
+		void Clear()
+		{
+			callsigns.Clear();
+			igates.Clear();
+			lastHeard.Clear();
+			packetCount.Clear();
+			lastIGate.Clear();
+			lastPositionTime.Clear();
+			latitude.Clear();
+			longitude.Clear();
+			positionCount.Clear();
+			symbol.Clear();
+		}
+	};
+
+	struct PathHop
+	{
+		// offset of the hop within the path
+		AL::uint16 Offset;
+		// length excluding the '*' used flag
+		AL::uint16 Length;
+		// the hop has been digipeated, either marked with '*' or preceding a marked hop
+		bool       IsUsed;
+		// an alias (WIDEn-N, TRACEn-N, RELAY, TCPIP, ...) rather than a station callsign
+		bool       IsAlias;
+		// n of WIDEn-N and TRACEn-N, 0 otherwise
+		AL::uint8  N;
+		// remaining hops of WIDEn-N and TRACEn-N, 0 otherwise
+		AL::uint8  Remaining;
+	};
+
+	// Splits a TNC2 digipeater path (Packet::DigiPath) into hops without copying
+	class Path
+	{
+	public:
+		static constexpr AL::size_t MAX_HOPS = 8;
+
+		// @return number of hops written to lpHops, hops beyond maxHops are ignored
+		static AL::size_t Decode(const AL::String& path, PathHop* lpHops, AL::size_t maxHops)
+		{
+			return Decode(path.GetCString(), path.GetLength(), lpHops, maxHops);
+		}
+		// @return number of hops written to lpHops, hops beyond maxHops are ignored
+		static AL::size_t Decode(const AL::String::Char* lpPath, AL::size_t length, PathHop* lpHops, AL::size_t maxHops)
+		{
+			AL::size_t count = 0;
+			AL::size_t used  = 0;
+
+			for (AL::size_t offset = 0; (offset < length) && (count < maxHops); )
+			{
+				auto size = Tokenizer::Find(&lpPath[offset], length - offset, ',');
+
+				if (size != 0)
+				{
+					auto& hop = lpHops[count++];
+
+					hop.Offset    = static_cast<AL::uint16>(offset);
+					hop.Length    = static_cast<AL::uint16>(size);
+					hop.IsUsed    = false;
+					hop.IsAlias   = false;
+					hop.N         = 0;
+					hop.Remaining = 0;
+
+					if (lpPath[offset + size - 1] == '*')
+					{
+						--hop.Length;
+						used = count;
+					}
+
+					DecodeAlias(&lpPath[offset], hop);
+				}
+
+				offset += size + 1;
+			}
+
+			// every hop before the last marked hop has been digipeated
+			for (AL::size_t i = 0; i < used; ++i)
+			{
+
+				lpHops[i].IsUsed = true;
+			}
+
+			return count;
+		}
+
+	private:
+		static void DecodeAlias(const AL::String::Char* lpHop, PathHop& hop)
+		{
+			static constexpr const char* ALIASES[] =
+			{
+				"WIDE", "TRACE", "RELAY", "TCPIP", "TCPXX", "NOGATE", "RFONLY", "ECHO", "GATE"
+			};
+
+			for (auto lpAlias : ALIASES)
+			{
+				auto aliasLength = ::strlen(lpAlias);
+
+				if ((hop.Length < aliasLength) || (::memcmp(lpHop, lpAlias, aliasLength) != 0))
+				{
+
+					continue;
+				}
+
+				auto lpSuffix     = &lpHop[aliasLength];
+				auto suffixLength = hop.Length - aliasLength;
+
+				// WIDEn-N, WIDEn and TRACEn-N
+				if ((suffixLength != 0) && (lpSuffix[0] >= '1') && (lpSuffix[0] <= '7') && (aliasLength <= 5))
+				{
+					if ((suffixLength == 1) || ((suffixLength == 3) && (lpSuffix[1] == '-') && (lpSuffix[2] >= '0') && (lpSuffix[2] <= '7')))
+					{
+						hop.IsAlias   = true;
+						hop.N         = static_cast<AL::uint8>(lpSuffix[0] - '0');
+						hop.Remaining = (suffixLength == 3) ? static_cast<AL::uint8>(lpSuffix[2] - '0') : 0;
+					}
+
+					return;
+				}
+
+				hop.IsAlias = (suffixLength == 0);
+
+				return;
+			}
+		}
+	};
+
+	// Digipeater and IGate coverage over a rolling time window
+	// Time is split into bucketCount buckets of bucketDuration. Each bucket keeps the counts
+	// added during it and running totals are kept for the whole window, so expiring a bucket
+	// subtracts its counts and every query reads the totals directly.
+	// Per packet the sender, each used digipeater and the IGate (RF-gated q constructs only)
+	// form a chain of edges, the first used digipeater and the IGate are credited with hearing
+	// the sender. Stations, digipeaters and IGates share one id space.
+	class PathAggregator
+	{
+		enum _KeyTypes : AL::uint64
+		{
+			_KEY_TYPE_EDGE               = 1,
+			_KEY_TYPE_DIGIPEATER_STATION = 2,
+			_KEY_TYPE_IGATE_STATION      = 3
+		};
+
+		struct _Bucket
+		{
+			AL::uint64          Index;
+			FlatMap<AL::uint32> Counts;
+		};
+
+		AL::uint64                             bucketDuration;
+		AL::uint64                             bucketIndex = 0;
+		AL::Collections::Array<_Bucket>        buckets;
+
+		CallsignTable                          names;
+		FlatMap<AL::uint32>                    totals;
+		AL::Collections::ArrayList<AL::uint32> digipeaterStations;
+		AL::Collections::ArrayList<AL::uint32> digipeaterPackets;
+		AL::Collections::ArrayList<AL::uint32> igateStations;
+		AL::Collections::ArrayList<AL::uint32> igatePackets;
+
+		PathAggregator(PathAggregator&&) = delete;
+		PathAggregator(const PathAggregator&) = delete;
+
+	public:
+		// @param bucketDuration in the unit of the timestamps passed to Add
+		PathAggregator(AL::uint64 bucketDuration, AL::size_t bucketCount)
+			: bucketDuration(
+				(bucketDuration != 0) ? bucketDuration : 1
+			),
+			buckets(
+				(bucketCount != 0) ? bucketCount : 1
+			)
+		{
+			for (AL::size_t i = 0; i < buckets.GetSize(); ++i)
+			{
+
+				buckets[i].Index = i;
+			}
+		}
+
+		auto& GetNames() const
+		{
+			return names;
+		}
+
+		// @return CallsignTable::INVALID_ID if not found
+		AL::uint32 Find(const AL::String& callsign) const
+		{
+			return names.Find(callsign);
+		}
+
+		// @return number of distinct stations heard directly by digipeater within the window
+		AL::uint32 GetDigipeaterStationCount(AL::uint32 id) const
+		{
+			return (id < digipeaterStations.GetSize()) ? digipeaterStations[id] : 0;
+		}
+
+		// @return number of packets heard directly by digipeater within the window
+		AL::uint32 GetDigipeaterPacketCount(AL::uint32 id) const
+		{
+			return (id < digipeaterPackets.GetSize()) ? digipeaterPackets[id] : 0;
+		}
+
+		// @return number of distinct stations gated by igate from RF within the window
+		AL::uint32 GetIGateStationCount(AL::uint32 id) const
+		{
+			return (id < igateStations.GetSize()) ? igateStations[id] : 0;
+		}
+
+		// @return number of packets gated by igate from RF within the window
+		AL::uint32 GetIGatePacketCount(AL::uint32 id) const
+		{
+			return (id < igatePackets.GetSize()) ? igatePackets[id] : 0;
+		}
+
+		// @return number of packets that travelled from -> to within the window
+		AL::uint32 GetEdgeCount(AL::uint32 from, AL::uint32 to) const
+		{
+			auto lpCount = totals.Find(MakeKey(_KEY_TYPE_EDGE, from, to));
+
+			return (lpCount != nullptr) ? *lpCount : 0;
+		}
+
+		// Calls callback(from, to, count) for every edge within the window
+		template<typename F>
+		void ForEachEdge(F&& callback) const
+		{
+			totals.ForEach([&callback](AL::uint64 key, AL::uint32 count)
+			{
+				if ((key >> 62) == _KEY_TYPE_EDGE)
+				{
+
+					callback(static_cast<AL::uint32>((key >> 31) & 0x7FFFFFFF), static_cast<AL::uint32>(key & 0x7FFFFFFF), count);
+				}
+			});
+		}
+
+		// Expires buckets older than the window ending at timestamp
+		void Advance(AL::uint64 timestamp)
+		{
+			auto index = timestamp / bucketDuration;
+
+			if (index <= bucketIndex)
+			{
+
+				return;
+			}
+
+			// buckets older than the window are all expired after bucketCount steps
+			auto first = ((index - bucketIndex) > buckets.GetSize()) ? (index - buckets.GetSize() + 1) : (bucketIndex + 1);
+
+			for (auto i = first; i <= index; ++i)
+			{
+				auto& bucket = buckets[i % buckets.GetSize()];
+
+				Expire(bucket);
+				bucket.Index = i;
+			}
+
+			bucketIndex = index;
+		}
+
+		// Adds packet to the bucket containing timestamp
+		// @return false if timestamp is older than the window
+		bool Add(AL::uint64 timestamp, const Packet& packet)
+		{
+			Advance(timestamp);
+
+			auto index = timestamp / bucketDuration;
+
+			if ((index + buckets.GetSize()) <= bucketIndex)
+			{
+
+				return false;
+			}
+
+			auto& bucket = buckets[index % buckets.GetSize()];
+
+			PathHop hops[Path::MAX_HOPS];
+			auto    hopCount = Path::Decode(packet.DigiPath, hops, Path::MAX_HOPS);
+
+			auto station = names.Intern(packet.Sender);
+			auto from    = station;
+			bool isFirst = true;
+
+			for (AL::size_t i = 0; (i < hopCount) && hops[i].IsUsed; ++i)
+			{
+				if (hops[i].IsAlias || (hops[i].Length == 0))
+				{
+					// an alias after a callsign is the hop that digipeater consumed,
+					// a leading alias means the first digipeater did not insert its callsign
+					if (isFirst)
+					{
+						isFirst = false;
+						from    = CallsignTable::INVALID_ID;
+					}
+
+					continue;
+				}
+
+				auto digipeater = names.Intern(&packet.DigiPath.GetCString()[hops[i].Offset], hops[i].Length);
+
+				if (isFirst)
+				{
+					Count(bucket, _KEY_TYPE_DIGIPEATER_STATION, digipeater, station);
+
+					isFirst = false;
+				}
+
+				if (from != CallsignTable::INVALID_ID)
+				{
+
+					Count(bucket, _KEY_TYPE_EDGE, from, digipeater);
+				}
+
+				from = digipeater;
+			}
+
+			if (IsGatedFromRF(packet.QFlag))
+			{
+				auto igate = names.Intern(packet.IGate);
+
+				Count(bucket, _KEY_TYPE_IGATE_STATION, igate, station);
+
+				if ((from != CallsignTable::INVALID_ID) && (from != igate))
+				{
+
+					Count(bucket, _KEY_TYPE_EDGE, from, igate);
+				}
+			}
+
+			return true;
+		}
+
+		// qAR, qAr and qAo are packets an IGate heard on RF
+		static bool IsGatedFromRF(const AL::String& qflag)
+		{
+			auto lpQFlag = qflag.GetCString();
+
+			return (qflag.GetLength() == 3) && (lpQFlag[0] == 'q') && (lpQFlag[1] == 'A') &&
+				((lpQFlag[2] == 'R') || (lpQFlag[2] == 'r') || (lpQFlag[2] == 'o'));
+		}
+
+	private:
+		static AL::uint64 MakeKey(AL::uint64 type, AL::uint32 a, AL::uint32 b)
+		{
+			return (type << 62) | (static_cast<AL::uint64>(a & 0x7FFFFFFF) << 31) | (b & 0x7FFFFFFF);
+		}
+
+		static AL::uint32& GetCount(AL::Collections::ArrayList<AL::uint32>& counts, AL::uint32 id)
+		{
+			while (counts.GetSize() <= id)
+			{
+
+				counts.PushBack(0);
+			}
+
+			return counts[id];
+		}
+
+		void Count(_Bucket& bucket, AL::uint64 type, AL::uint32 a, AL::uint32 b)
+		{
+			auto key = MakeKey(type, a, b);
+
+			++bucket.Counts.Insert(key);
+
+			if (++totals.Insert(key) == 1)
+			{
+				switch (type)
+				{
+					case _KEY_TYPE_DIGIPEATER_STATION: ++GetCount(digipeaterStations, a); break;
+					case _KEY_TYPE_IGATE_STATION:      ++GetCount(igateStations, a);      break;
+				}
+			}
+
+			switch (type)
+			{
+				case _KEY_TYPE_DIGIPEATER_STATION: ++GetCount(digipeaterPackets, a); break;
+				case _KEY_TYPE_IGATE_STATION:      ++GetCount(igatePackets, a);      break;
+			}
+		}
+
+		void Expire(_Bucket& bucket)
+		{
+			bucket.Counts.ForEach([this](AL::uint64 key, AL::uint32 count)
+			{
+				auto  type  = key >> 62;
+				auto  a     = static_cast<AL::uint32>((key >> 31) & 0x7FFFFFFF);
+				auto& total = *totals.Find(key);
+
+				if ((total -= count) == 0)
+				{
+					totals.Remove(key);
+
+					switch (type)
+					{
+						case _KEY_TYPE_DIGIPEATER_STATION: --digipeaterStations[a]; break;
+						case _KEY_TYPE_IGATE_STATION:      --igateStations[a];      break;
+					}
+				}
+
+				switch (type)
+				{
+					case _KEY_TYPE_DIGIPEATER_STATION: digipeaterPackets[a] -= count; break;
+					case _KEY_TYPE_IGATE_STATION:      igatePackets[a] -= count;      break;
+				}
+			});
+
+			bucket.Counts.Clear();
+		}
+	};
+
+	// Packet logs are a sequence of self-contained blocks. Each block carries a fixed
+	// header with the time range and record count, a block-local string table, the
+	// sorted set of sender ids appearing in the block and then one column per field:
+	//	time     - zigzag varint delta from the previous record (first from TimeMin)
+	//	sender   - varint string id (same for tocall, digipath, qflag and igate)
+	//	position - 1 flag byte per record, then for each position record zigzag varint
+	//	           deltas of fixed-point latitude/longitude, altitude, symbol and comment
+	//	content  - varint length + bytes
+	// Readers skip blocks by header alone and only decode the sender index and the
+	// time/sender columns of blocks that may match before decoding the remaining
+	// columns and materializing the records that do.
+	struct PacketLogBlockHeader
+	{
+		static constexpr AL::uint32 MAGIC    = 0x424C5041; // "APLB"
+		static constexpr AL::size_t SIZE     = 40;
+		// upper bound of Size, readers reject larger blocks instead of allocating them
+		static constexpr AL::uint32 MAX_SIZE = 16 * 1024 * 1024;
+
+		AL::uint32 Magic;
+		AL::uint32 Size;
+		AL::uint32 RecordCount;
+		AL::uint32 StringCount;
+		AL::uint32 SenderCount;
+		AL::uint32 Reserved;
+		AL::uint64 TimeMin;
+		AL::uint64 TimeMax;
+	};
+
+	// @throw AL::Exception
+	// @return false on error
+	typedef AL::Function<bool(const void* lpBuffer, AL::size_t size)>                                   PacketLogSink;
+	// @throw AL::Exception
+	// @return false on end of stream
+	typedef AL::Function<bool(void* lpBuffer, AL::size_t size)>                                         PacketLogSource;
+	// @throw AL::Exception
+	// @return false to stop reading
+	typedef AL::Function<bool(AL::uint64 timestamp, const Packet& packet, const Position* lpPosition)> PacketLogReaderCallback;
+
+	struct PacketLogQuery
+	{
+		// inclusive
+		AL::uint64                         TimeBegin = 0;
+		// inclusive
+		AL::uint64                         TimeEnd   = 0xFFFFFFFFFFFFFFFF;
+		// empty to match any sender
+		AL::Collections::Array<AL::String> Senders;
+	};
+
+	class PacketLogWriter
+	{
+		struct _Record
+		{
+			AL::uint64 Timestamp;
+			AL::uint32 Sender;
+			AL::uint32 ToCall;
+			AL::uint32 DigiPath;
+			AL::uint32 QFlag;
+			AL::uint32 IGate;
+			AL::String Content;
+
+			bool       HasPosition;
+			AL::int32  Latitude;
+			AL::int32  Longitude;
+			Position   Location;
+		};
+
+		PacketLogSink                         sink;
+		AL::size_t                            blockSize;
+		CallsignTable                         strings;
+		AL::Collections::ArrayList<_Record>   records;
+		AL::Collections::ArrayList<AL::uint8> buffer;
+
+		PacketLogWriter(PacketLogWriter&&) = delete;
+		PacketLogWriter(const PacketLogWriter&) = delete;
+
+	public:
+		explicit PacketLogWriter(PacketLogSink&& sink, AL::size_t blockSize = 4096)
+			: sink(
+				AL::Move(sink)
+			),
+			blockSize(
+				blockSize
+			)
+		{
+		}
+
+		// Note: buffered records are flushed, errors are ignored (call Flush to handle them)
+		virtual ~PacketLogWriter()
+		{
+			try
+			{
+				Flush();
+			}
+			catch (AL::Exception&)
+			{
+			}
+		}
+
+		auto GetBlockSize() const
+		{
+			return blockSize;
+		}
+
+		// @throw AL::Exception
+		void Write(AL::uint64 timestamp, const Packet& packet)
+		{
+			Write(timestamp, packet, nullptr);
+		}
+		// @throw AL::Exception
+		void Write(AL::uint64 timestamp, const Packet& packet, const Position& position)
+		{
+			Write(timestamp, packet, &position);
+		}
+
+		// @throw AL::Exception
+		void Flush()
+		{
+			if (records.GetSize() == 0)
+			{
+
+				return;
+			}
+
+			// pending records are dropped on error so a failing block does not fail every later Write
+			try
+			{
+				WriteBlock(0, records.GetSize());
+			}
+			catch (AL::Exception&)
+			{
+				records.Clear();
+				strings.Clear();
+
+				throw;
+			}
+
+			records.Clear();
+			strings.Clear();
+		}
+
+		static void EncodeHeader(AL::uint8(&buffer)[PacketLogBlockHeader::SIZE], const PacketLogBlockHeader& header)
+		{
+			auto write = [&buffer](AL::size_t offset, AL::uint64 value, AL::size_t size)
+			{
+				for (AL::size_t i = 0; i < size; ++i, value >>= 8)
+				{
+
+					buffer[offset + i] = static_cast<AL::uint8>(value & 0xFF);
+				}
+			};
+
+			write(0,  header.Magic,       4);
+			write(4,  header.Size,        4);
+			write(8,  header.RecordCount, 4);
+			write(12, header.StringCount, 4);
+			write(16, header.SenderCount, 4);
+			write(20, header.Reserved,    4);
+			write(24, header.TimeMin,     8);
+			write(32, header.TimeMax,     8);
+		}
+
+		static constexpr AL::uint64 ZigZag(AL::int64 value)
+		{
+			return (static_cast<AL::uint64>(value) << 1) ^ static_cast<AL::uint64>(value >> 63);
+		}
+
+	private:
+		// @throw AL::Exception
+		void Write(AL::uint64 timestamp, const Packet& packet, const Position* lpPosition)
+		{
+			_Record record =
+			{
+				.Timestamp   = timestamp,
+				.Sender      = strings.Intern(packet.Sender),
+				.ToCall      = strings.Intern(packet.ToCall),
+				.DigiPath    = strings.Intern(packet.DigiPath),
+				.QFlag       = strings.Intern(packet.QFlag),
+				.IGate       = strings.Intern(packet.IGate),
+				.Content     = packet.Content,
+				.HasPosition = lpPosition != nullptr,
+				.Latitude    = 0,
+				.Longitude   = 0
+			};
+
+			if (lpPosition != nullptr)
+			{
+				record.Latitude  = Position::ToFixedPoint(lpPosition->Latitude);
+				record.Longitude = Position::ToFixedPoint(lpPosition->Longitude);
+				record.Location  = *lpPosition;
+			}
+
+			records.PushBack(AL::Move(record));
+
+			if (records.GetSize() >= blockSize)
+			{
+
+				Flush();
+			}
+		}
+
+		// Writes records [first, first + count) as one block, halving it until it fits PacketLogBlockHeader::MAX_SIZE
+		// Every block carries the whole string table so the halves stay self-contained
+		// @throw AL::Exception
+		void WriteBlock(AL::size_t first, AL::size_t count)
+		{
+			buffer.Clear();
+
+			PacketLogBlockHeader header =
+			{
+				.Magic       = PacketLogBlockHeader::MAGIC,
+				.Size        = 0,
+				.RecordCount = static_cast<AL::uint32>(count),
+				.StringCount = static_cast<AL::uint32>(strings.GetSize()),
+				.SenderCount = 0,
+				.Reserved    = 0,
+				.TimeMin     = records[first].Timestamp,
+				.TimeMax     = records[first].Timestamp
+			};
+
+			auto last = first + count;
+
+			for (auto i = first; i < last; ++i)
+			{
+				if (records[i].Timestamp < header.TimeMin) header.TimeMin = records[i].Timestamp;
+				if (records[i].Timestamp > header.TimeMax) header.TimeMax = records[i].Timestamp;
+			}
+
+			for (AL::uint32 i = 0; i < header.StringCount; ++i)
+			{
+				auto& string = strings.Get(i);
+
+				WriteVarInt(string.GetLength());
+				WriteBytes(string.GetCString(), string.GetLength());
+			}
+
+			{
+				// strings are interned in first-use order so a flag per id is enough to build the sorted sender set
+				AL::Collections::Array<bool> senders(header.StringCount);
+
+				for (auto& sender : senders)
+				{
+
+					sender = false;
+				}
+
+				for (auto i = first; i < last; ++i)
+				{
+
+					senders[records[i].Sender] = true;
+				}
+
+				for (AL::uint32 i = 0, previous = 0; i < header.StringCount; ++i)
+				{
+					if (senders[i])
+					{
+						WriteVarInt(i - previous);
+						previous = i;
+
+						++header.SenderCount;
+					}
+				}
+			}
+
+			{
+				auto previous = header.TimeMin;
+
+				for (auto i = first; i < last; ++i)
+				{
+					WriteVarInt(ZigZag(static_cast<AL::int64>(records[i].Timestamp - previous)));
+					previous = records[i].Timestamp;
+				}
+			}
+
+			for (auto i = first; i < last; ++i) WriteVarInt(records[i].Sender);
+			for (auto i = first; i < last; ++i) WriteVarInt(records[i].ToCall);
+			for (auto i = first; i < last; ++i) WriteVarInt(records[i].DigiPath);
+			for (auto i = first; i < last; ++i) WriteVarInt(records[i].QFlag);
+			for (auto i = first; i < last; ++i) WriteVarInt(records[i].IGate);
+
+			for (auto i = first; i < last; ++i)
+			{
+
+				buffer.PushBack(records[i].HasPosition ? 1 : 0);
+			}
+
+			{
+				AL::int32 latitude  = 0;
+				AL::int32 longitude = 0;
+
+				for (auto i = first; i < last; ++i)
+				{
+					auto& record = records[i];
+
+					if (record.HasPosition)
+					{
+						WriteVarInt(ZigZag(static_cast<AL::int64>(record.Latitude) - latitude));
+						WriteVarInt(ZigZag(static_cast<AL::int64>(record.Longitude) - longitude));
+						WriteVarInt(ZigZag(record.Location.Altitude));
+						buffer.PushBack(static_cast<AL::uint8>(record.Location.SymbolTable));
+						buffer.PushBack(static_cast<AL::uint8>(record.Location.SymbolTableKey));
+						WriteVarInt(record.Location.Comment.GetLength());
+						WriteBytes(record.Location.Comment.GetCString(), record.Location.Comment.GetLength());
+
+						latitude  = record.Latitude;
+						longitude = record.Longitude;
+					}
+				}
+			}
+
+			for (auto i = first; i < last; ++i)
+			{
+				WriteVarInt(records[i].Content.GetLength());
+				WriteBytes(records[i].Content.GetCString(), records[i].Content.GetLength());
+			}
+
+			if (buffer.GetSize() > PacketLogBlockHeader::MAX_SIZE)
+			{
+				if (count == 1)
+				{
+
+					throw AL::Exception(
+						"Record exceeds PacketLogBlockHeader::MAX_SIZE"
+					);
+				}
+
+				WriteBlock(first, count / 2);
+				WriteBlock(first + (count / 2), count - (count / 2));
+
+				return;
+			}
+
+			header.Size = static_cast<AL::uint32>(buffer.GetSize());
+
+			AL::uint8 headerBuffer[PacketLogBlockHeader::SIZE];
+			EncodeHeader(headerBuffer, header);
+
+			if (!sink(headerBuffer, sizeof(headerBuffer)) || !sink(&buffer[0], buffer.GetSize()))
+			{
+
+				throw AL::Exception(
+					"Error writing block"
+				);
+			}
+		}
+
+		void WriteVarInt(AL::uint64 value)
+		{
+			while (value >= 0x80)
+			{
+				buffer.PushBack(static_cast<AL::uint8>(value | 0x80));
+				value >>= 7;
+			}
+
+			buffer.PushBack(static_cast<AL::uint8>(value));
+		}
+
+		void WriteBytes(const AL::String::Char* lpBuffer, AL::size_t size)
+		{
+			for (AL::size_t i = 0; i < size; ++i)
+			{
+
+				buffer.PushBack(static_cast<AL::uint8>(lpBuffer[i]));
+			}
+		}
+	};
+
+	class PacketLogReader
+	{
+		// a string table entry within buffer
+		struct _String
+		{
+			AL::size_t Offset;
+			AL::size_t Length;
+		};
+
+		PacketLogSource                        source;
+		AL::Collections::Array<AL::uint8>      buffer;
+
+		AL::size_t                             bufferOffset = 0;
+		AL::size_t                             bufferSize   = 0;
+
+		AL::Collections::ArrayList<_String>    strings;
+		AL::Collections::ArrayList<AL::uint64> timestamps;
+		AL::Collections::ArrayList<AL::uint32> senders;
+		AL::Collections::ArrayList<AL::uint32> columns;
+		AL::Collections::ArrayList<bool>       matches;
+
+		PacketLogReader(PacketLogReader&&) = delete;
+		PacketLogReader(const PacketLogReader&) = delete;
+
+	public:
+		explicit PacketLogReader(PacketLogSource&& source)
+			: source(
+				AL::Move(source)
+			)
+		{
+		}
+
+		virtual ~PacketLogReader()
+		{
+		}
+
+		// @throw AL::Exception
+		// @return number of records passed to callback
+		AL::size_t Read(const PacketLogReaderCallback& callback)
+		{
+			return Read(PacketLogQuery(), callback);
+		}
+		// @throw AL::Exception
+		// @return number of records passed to callback
+		AL::size_t Read(const PacketLogQuery& query, const PacketLogReaderCallback& callback)
+		{
+			AL::size_t           count = 0;
+			PacketLogBlockHeader header;
+
+			while (ReadBlock(header))
+			{
+				if ((header.TimeMax < query.TimeBegin) || (header.TimeMin > query.TimeEnd))
+				{
+
+					continue;
+				}
+
+				bool isStopped = false;
+
+				count += ReadRecords(header, query, callback, isStopped);
+
+				if (isStopped)
+				{
+
+					break;
+				}
+			}
+
+			return count;
+		}
+
+		static void DecodeHeader(PacketLogBlockHeader& header, const AL::uint8(&buffer)[PacketLogBlockHeader::SIZE])
+		{
+			auto read = [&buffer](AL::size_t offset, AL::size_t size)
+			{
+				AL::uint64 value = 0;
+
+				for (AL::size_t i = size; i > 0; --i)
+				{
+
+					value = (value << 8) | buffer[offset + i - 1];
+				}
+
+				return value;
+			};
+
+			header.Magic       = static_cast<AL::uint32>(read(0,  4));
+			header.Size        = static_cast<AL::uint32>(read(4,  4));
+			header.RecordCount = static_cast<AL::uint32>(read(8,  4));
+			header.StringCount = static_cast<AL::uint32>(read(12, 4));
+			header.SenderCount = static_cast<AL::uint32>(read(16, 4));
+			header.Reserved    = static_cast<AL::uint32>(read(20, 4));
+			header.TimeMin     = read(24, 8);
+			header.TimeMax     = read(32, 8);
+		}
+
+		static constexpr AL::int64 UnZigZag(AL::uint64 value)
+		{
+			return static_cast<AL::int64>(value >> 1) ^ -static_cast<AL::int64>(value & 1);
+		}
+
+	private:
+		// @throw AL::Exception
+		// @return false on end of stream
+		bool ReadBlock(PacketLogBlockHeader& header)
+		{
+			AL::uint8 headerBuffer[PacketLogBlockHeader::SIZE];
+
+			if (!source(headerBuffer, sizeof(headerBuffer)))
+			{
+
+				return false;
+			}
+
+			DecodeHeader(header, headerBuffer);
+
+			if (header.Magic != PacketLogBlockHeader::MAGIC)
+			{
+
+				throw AL::Exception(
+					"Invalid block header"
+				);
+			}
+
+			// every record, string and sender index entry takes at least 1 byte
+			if ((header.Size > PacketLogBlockHeader::MAX_SIZE) || (header.RecordCount > header.Size) || (header.StringCount > header.Size) || (header.SenderCount > header.Size))
+			{
+
+				throw AL::Exception(
+					"Invalid block size"
+				);
+			}
+
+			if (buffer.GetSize() < header.Size)
+			{
+
+				buffer = AL::Collections::Array<AL::uint8>(header.Size);
+			}
+
+			if ((header.Size != 0) && !source(&buffer[0], header.Size))
+			{
+
+				throw AL::Exception(
+					"Unexpected end of stream"
+				);
+			}
+
+			bufferOffset = 0;
+			bufferSize   = header.Size;
+
+			return true;
+		}
+
+		// @throw AL::Exception
+		AL::size_t ReadRecords(const PacketLogBlockHeader& header, const PacketLogQuery& query, const PacketLogReaderCallback& callback, bool& isStopped)
+		{
+			// strings stay in buffer until a record using them is returned
+			strings.Clear();
+
+			for (AL::uint32 i = 0; i < header.StringCount; ++i)
+			{
+				auto length = ReadVarInt();
+				auto offset = bufferOffset;
+
+				ReadBytes(length);
+				strings.PushBack(_String { .Offset = offset, .Length = length });
+			}
+
+			// resolve the query senders against this block, skipping it if none appear in the sender index
+			senders.Clear();
+
+			for (AL::uint32 i = 0, id = 0; i < header.SenderCount; ++i)
+			{
+				id += static_cast<AL::uint32>(ReadVarInt());
+
+				if (id >= header.StringCount)
+				{
+
+					throw AL::Exception(
+						"Invalid string id"
+					);
+				}
+
+				if (query.Senders.GetSize() == 0)
+				{
+
+					continue;
+				}
+
+				for (auto& sender : query.Senders)
+				{
+					if ((strings[id].Length == sender.GetLength()) && (::memcmp(&buffer[strings[id].Offset], sender.GetCString(), sender.GetLength()) == 0))
+					{
+						senders.PushBack(id);
+
+						break;
+					}
+				}
+			}
+
+			if ((query.Senders.GetSize() != 0) && (senders.GetSize() == 0))
+			{
+
+				return 0;
+			}
+
+			timestamps.Clear();
+			matches.Clear();
+
+			for (AL::uint32 i = 0; i < header.RecordCount; ++i)
+			{
+				auto timestamp = (i == 0) ? header.TimeMin : timestamps[i - 1];
+				timestamp     += static_cast<AL::uint64>(UnZigZag(ReadVarInt()));
+
+				timestamps.PushBack(timestamp);
+				matches.PushBack((timestamp >= query.TimeBegin) && (timestamp <= query.TimeEnd));
+			}
+
+			// sender, the remaining columns are only decoded if a record matches
+			columns.Clear();
+			ReadStringIds(header, header.RecordCount);
+
+			AL::size_t matchCount = 0;
+
+			for (AL::uint32 i = 0; i < header.RecordCount; ++i)
+			{
+				if (matches[i] && (senders.GetSize() != 0))
+				{
+					bool isMatch = false;
+
+					for (auto sender : senders)
+					{
+						if (columns[i] == sender)
+						{
+							isMatch = true;
+
+							break;
+						}
+					}
+
+					matches[i] = isMatch;
+				}
+
+				if (matches[i])
+				{
+
+					++matchCount;
+				}
+			}
+
+			if (matchCount == 0)
+			{
+
+				return 0;
+			}
+
+			// tocall, digipath, qflag, igate
+			ReadStringIds(header, header.RecordCount * 4);
+
+			auto lpFlags = ReadBytes(header.RecordCount);
+
+			AL::Collections::ArrayList<Position> positions;
+
+			{
+				AL::int64 latitude  = 0;
+				AL::int64 longitude = 0;
+
+				for (AL::uint32 i = 0; i < header.RecordCount; ++i)
+				{
+					if (lpFlags[i] == 0)
+					{
+
+						continue;
+					}
+
+					ReadCoordinate(latitude,  90);
+					ReadCoordinate(longitude, 180);
+
+					Position position;
+					position.Latitude       = Position::FromFixedPoint(static_cast<AL::int32>(latitude));
+					position.Longitude      = Position::FromFixedPoint(static_cast<AL::int32>(longitude));
+					position.Altitude       = static_cast<AL::int32>(UnZigZag(ReadVarInt()));
+					position.SymbolTable    = *ReadBytes(1);
+					position.SymbolTableKey = *ReadBytes(1);
+
+					auto commentLength = ReadVarInt();
+					position.Comment   = AL::String(ReadBytes(commentLength), commentLength);
+
+					positions.PushBack(AL::Move(position));
+				}
+			}
+
+			AL::size_t count         = 0;
+			AL::size_t positionIndex = 0;
+
+			for (AL::uint32 i = 0; i < header.RecordCount; ++i)
+			{
+				auto contentLength = ReadVarInt();
+				auto lpContent     = ReadBytes(contentLength);
+				auto lpPosition    = (lpFlags[i] != 0) ? &positions[positionIndex++] : nullptr;
+
+				if (!matches[i])
+				{
+
+					continue;
+				}
+
+				Packet packet =
+				{
+					.IGate    = GetString(columns[(header.RecordCount * 4) + i]),
+					.QFlag    = GetString(columns[(header.RecordCount * 3) + i]),
+					.ToCall   = GetString(columns[(header.RecordCount * 1) + i]),
+					.Sender   = GetString(columns[i]),
+					.Content  = AL::String(lpContent, contentLength),
+					.DigiPath = GetString(columns[(header.RecordCount * 2) + i])
+				};
+
+				++count;
+
+				if (!callback(timestamps[i], packet, lpPosition))
+				{
+					isStopped = true;
+
+					break;
+				}
+			}
+
+			return count;
+		}
+
+		AL::String GetString(AL::uint32 id) const
+		{
+			return AL::String(reinterpret_cast<const AL::String::Char*>(&buffer[strings[id].Offset]), strings[id].Length);
+		}
+
+		// Applies the next delta to a fixed-point coordinate
+		// @throw AL::Exception
+		void ReadCoordinate(AL::int64& value, AL::int64 maxDegrees)
+		{
+			constexpr AL::int64 SCALE = Position::FIXED_POINT_SCALE;
+
+			auto delta = UnZigZag(ReadVarInt());
+
+			// bounded first so the sum can not overflow
+			if ((delta < (-2 * maxDegrees * SCALE)) || (delta > (2 * maxDegrees * SCALE)) ||
+				((value += delta) < (-maxDegrees * SCALE)) || (value > (maxDegrees * SCALE)))
+			{
+
+				throw AL::Exception(
+					"Invalid position"
+				);
+			}
+		}
+
+		// @throw AL::Exception
+		void ReadStringIds(const PacketLogBlockHeader& header, AL::uint32 count)
+		{
+			for (AL::uint32 i = 0; i < count; ++i)
+			{
+				auto id = static_cast<AL::uint32>(ReadVarInt());
+
+				if (id >= header.StringCount)
+				{
+
+					throw AL::Exception(
+						"Invalid string id"
+					);
+				}
+
+				columns.PushBack(id);
+			}
+		}
+
+		// @throw AL::Exception
+		AL::uint64 ReadVarInt()
+		{
+			AL::uint64 value = 0;
+
+			for (AL::size_t shift = 0; shift < 64; shift += 7)
+			{
+				auto byte = static_cast<AL::uint8>(*ReadBytes(1));
+				value    |= static_cast<AL::uint64>(byte & 0x7F) << shift;
+
+				if ((byte & 0x80) == 0)
+				{
+
+					return value;
+				}
+			}
+
+			throw AL::Exception(
+				"Invalid varint"
+			);
+		}
+
+		// @throw AL::Exception
+		const AL::String::Char* ReadBytes(AL::size_t size)
+		{
+			if ((bufferSize - bufferOffset) < size)
+			{
+
+				throw AL::Exception(
+					"Unexpected end of block"
+				);
+			}
+
+			if (size == 0)
+			{
+
+				return "";
+			}
+
+			auto lpBuffer = reinterpret_cast<const AL::String::Char*>(&buffer[bufferOffset]);
+			bufferOffset += size;
+
+			return lpBuffer;
+		}
+	};
+
+	// Decoded lines in structure-of-arrays form, one entry per packet in input order
+	struct BatchDecodeResult
+	{
+		CallsignTable                          Senders;
+
+		// id in Senders
+		AL::Collections::ArrayList<AL::uint32> Sender;
+		// leading decimal prefix of the line ("1700000000 N0CALL>APRS,..."), 0 if absent
+		AL::Collections::ArrayList<AL::uint64> Timestamp;
+		AL::Collections::ArrayList<DataTypes>  DataType;
+		// fixed-point (see Position::FIXED_POINT_SCALE), 0 if HasPosition is false
+		AL::Collections::ArrayList<AL::int32>  Latitude;
+		AL::Collections::ArrayList<AL::int32>  Longitude;
+		AL::Collections::ArrayList<bool>       HasPosition;
+
+		// number of lines read, including those that failed to decode
+		AL::size_t                             LineCount  = 0;
+		// number of lines that are not packets (server comments, malformed headers)
+		AL::size_t                             ErrorCount = 0;
+
+		AL::size_t GetSize() const
+		{
+			return Sender.GetSize();
+		}
+
+		void Clear()
+		{
+			Senders.Clear();
+			Sender.Clear();
+			Timestamp.Clear();
+			DataType.Clear();
+			Latitude.Clear();
+			Longitude.Clear();
+			HasPosition.Clear();
+
+			LineCount  = 0;
+			ErrorCount = 0;
+		}
+	};
+
+	// Decodes large buffers of TNC2 lines on every core
+	// The buffer is split into chunks on line boundaries. Threads claim chunks from a shared
+	// counter until none remain, so a thread stuck on a slow chunk never holds up the rest.
+	// Each chunk is decoded into its own result which are merged in order afterwards.
+	// Note: positions are read with Position::DecodeCoordinates and do not allocate
+	class BatchDecoder
+	{
+		struct _Chunk
+		{
+			AL::size_t        Begin;
+			AL::size_t        End;
+			BatchDecodeResult Result;
+		};
+
+		AL::size_t threadCount;
+		AL::size_t chunkSize;
+
+	public:
+		// @param threadCount 0 to use every core
+		explicit BatchDecoder(AL::size_t threadCount = 0, AL::size_t chunkSize = 1024 * 1024)
+			: threadCount(
+				(threadCount != 0) ? threadCount : std::thread::hardware_concurrency()
+			),
+			chunkSize(
+				(chunkSize != 0) ? chunkSize : 1
+			)
+		{
+			if (this->threadCount == 0)
+			{
+
+				this->threadCount = 1;
+			}
+		}
+
+		auto GetThreadCount() const
+		{
+			return threadCount;
+		}
+
+		auto GetChunkSize() const
+		{
+			return chunkSize;
+		}
+
+		// Appends every line in lpBuffer to result
+		// @param isFinal false to leave a trailing line without a terminator for the next call
+		// @return number of bytes consumed
+		AL::size_t Decode(BatchDecodeResult& result, const AL::String::Char* lpBuffer, AL::size_t size, bool isFinal = true) const
+		{
+			if (!isFinal)
+			{
+				while ((size != 0) && (lpBuffer[size - 1] != '\n'))
+				{
+
+					--size;
+				}
+			}
+
+			if (size == 0)
+			{
+
+				return 0;
+			}
+
+			auto chunkCount = (size + chunkSize - 1) / chunkSize;
+			auto workers    = (threadCount < chunkCount) ? threadCount : chunkCount;
+
+			AL::Collections::Array<_Chunk> chunks(chunkCount);
+			std::atomic<AL::size_t>        nextChunk(0);
+
+			auto worker = [this, &chunks, &nextChunk, chunkCount, lpBuffer, size]()
+			{
+				for (AL::size_t i; (i = nextChunk.fetch_add(1, std::memory_order_relaxed)) < chunkCount; )
+				{
+					auto& chunk = chunks[i];
+					chunk.Begin = FindChunkBegin(lpBuffer, size, i);
+					chunk.End   = FindChunkBegin(lpBuffer, size, i + 1);
+
+					DecodeChunk(chunk.Result, &lpBuffer[chunk.Begin], chunk.End - chunk.Begin);
+				}
+			};
+
+			{
+				AL::Collections::Array<std::thread> threads(workers - 1);
+
+				for (auto& thread : threads)
+				{
+
+					thread = std::thread(worker);
+				}
+
+				worker();
+
+				for (auto& thread : threads)
+				{
+
+					thread.join();
+				}
+			}
+
+			for (auto& chunk : chunks)
+			{
+
+				Merge(result, chunk.Result);
+			}
+
+			return size;
+		}
+
+		// Decodes lpBuffer on the calling thread
+		static void DecodeChunk(BatchDecodeResult& result, const AL::String::Char* lpBuffer, AL::size_t size)
+		{
+			TokenizerLine lines[64];
+
+			for (AL::size_t offset = 0; offset < size; )
+			{
+				AL::size_t consumed;
+				auto       count = Tokenizer::Tokenize(&lpBuffer[offset], size - offset, lines, sizeof(lines) / sizeof(lines[0]), consumed);
+
+				if (count == 0)
+				{
+					// trailing line without a terminator
+					Tokenizer::TokenizeLine(&lpBuffer[offset], size - offset, lines[0]);
+					DecodeLine(result, &lpBuffer[offset], lines[0]);
+
+					break;
+				}
+
+				for (AL::size_t i = 0; i < count; ++i)
+				{
+
+					DecodeLine(result, &lpBuffer[offset + lines[i].Offset], lines[i]);
+				}
+
+				offset += consumed;
+			}
+		}
+
+	private:
+		// @return offset of the first line starting at or after index * chunkSize
+		AL::size_t FindChunkBegin(const AL::String::Char* lpBuffer, AL::size_t size, AL::size_t index) const
+		{
+			if (index == 0)
+			{
+
+				return 0;
+			}
+
+			auto offset = index * chunkSize;
+
+			if (offset >= size)
+			{
+
+				return size;
+			}
+
+			offset += Tokenizer::Find(&lpBuffer[offset - 1], size - offset + 1, '\n');
+
+			return (offset < size) ? offset : size;
+		}
+
+		static void DecodeLine(BatchDecodeResult& result, const AL::String::Char* lpLine, const TokenizerLine& line)
+		{
+			++result.LineCount;
+
+			AL::uint64 timestamp = 0;
+			AL::size_t prefix    = 0;
+
+			while ((prefix < line.Length) && (lpLine[prefix] >= '0') && (lpLine[prefix] <= '9'))
+			{
+
+				timestamp = (timestamp * 10) + (lpLine[prefix++] - '0');
+			}
+
+			TokenizerLine        packetLine;
+			const TokenizerLine* lpPacketLine = &line;
+
+			if ((prefix != 0) && (prefix < line.Length) && (lpLine[prefix] == ' '))
+			{
+				// digits and spaces are never delimiters so the offsets only need shifting
+				++prefix;
+
+				packetLine.Offset         = line.Offset + prefix;
+				packetLine.Length         = line.Length - prefix;
+				packetLine.DelimiterCount = line.DelimiterCount;
+
+				auto delimiterCount = (line.DelimiterCount < TokenizerLine::MAX_DELIMITERS) ? line.DelimiterCount : TokenizerLine::MAX_DELIMITERS;
+
+				for (AL::size_t i = 0; i < delimiterCount; ++i)
+				{
+
+					packetLine.Delimiters[i] = static_cast<AL::uint32>(line.Delimiters[i] - prefix);
+				}
+
+				lpLine      += prefix;
+				lpPacketLine = &packetLine;
+			}
+			else
+			{
+
+				timestamp = 0;
+			}
+
+			PacketSpan span;
+
+			if (!Packet::Decode(span, lpLine, *lpPacketLine))
+			{
+				++result.ErrorCount;
+
+				return;
+			}
+
+			Append(result, timestamp, lpLine, lpPacketLine->Length, span);
+		}
+
+		static void Append(BatchDecodeResult& result, AL::uint64 timestamp, const AL::String::Char* lpLine, AL::size_t length, const PacketSpan& span)
+		{
+			auto lpContent     = &lpLine[span.Content + 1];
+			auto contentLength = length - span.Content - 1;
+			auto dataType      = Packet::GetDataType(lpContent[0]);
+
+			AL::Float        latitude  = 0;
+			AL::Float        longitude = 0;
+			AL::String::Char table, key;
+			bool             hasPosition = false;
+
+			if (dataType == DataTypes::Position)
+			{
+
+				hasPosition = (contentLength > Position::COORDINATES_LENGTH) && Position::DecodeCoordinates(&lpContent[1], latitude, longitude, table, key);
+			}
+
+			result.Sender.PushBack(result.Senders.Intern(lpLine, span.ToCall));
+			result.Timestamp.PushBack(timestamp);
+			result.DataType.PushBack(dataType);
+			result.Latitude.PushBack(hasPosition ? Position::ToFixedPoint(latitude) : 0);
+			result.Longitude.PushBack(hasPosition ? Position::ToFixedPoint(longitude) : 0);
+			result.HasPosition.PushBack(hasPosition);
+		}
+
+		static void Merge(BatchDecodeResult& result, const BatchDecodeResult& chunk)
+		{
+			AL::Collections::Array<AL::uint32> senders(chunk.Senders.GetSize());
+
+			for (AL::uint32 id = 0; id < senders.GetSize(); ++id)
+			{
+
+				senders[id] = result.Senders.Intern(chunk.Senders.Get(id));
+			}
+
+			for (AL::size_t i = 0; i < chunk.GetSize(); ++i)
+			{
+				result.Sender.PushBack(senders[chunk.Sender[i]]);
+				result.Timestamp.PushBack(chunk.Timestamp[i]);
+				result.DataType.PushBack(chunk.DataType[i]);
+				result.Latitude.PushBack(chunk.Latitude[i]);
+				result.Longitude.PushBack(chunk.Longitude[i]);
+				result.HasPosition.PushBack(chunk.HasPosition[i]);
+			}
+
+			result.LineCount  += chunk.LineCount;
+			result.ErrorCount += chunk.ErrorCount;
+		}
+	};
+
+	// @return false to stop
+	typedef AL::Function<bool(const AL::String& line, const AL::String& mismatch)> DecoderDifferentialCallback;
+
+	// Runs untrusted input through every decoder and compares fast paths against their reference implementations
+	// Intended to be driven by a fuzzer (one input per call to Compare, see fuzz/FuzzDifferential.cpp) or an offline corpus (CompareCorpus)
+	class DecoderDifferential
+	{
+	public:
+		// Compares Packet::Decode against Packet::DecodeRegex and, when a packet is decoded,
+		// Position::DecodeCoordinates against Position::Decode before running every content decoder
+		// @param mismatch receives the name of the mismatching decoder and field
+		// @return false on mismatch
+		static bool Compare(const AL::String& line, AL::String& mismatch)
+		{
+			Packet packet;
+			Packet reference;
+
+			auto isDecoded          = Packet::Decode(packet, line);
+			auto isReferenceDecoded = Packet::DecodeRegex(reference, line);
+
+			if (isDecoded != isReferenceDecoded)
+			{
+				mismatch = AL::String::Format("Packet::Decode returned %s", isDecoded ? "true" : "false");
+
+				return false;
+			}
+
+			if (!isDecoded)
+			{
+
+				return true;
+			}
+
+			if (!CompareField(mismatch, "Packet::Decode Sender", packet.Sender, reference.Sender) ||
+				!CompareField(mismatch, "Packet::Decode ToCall", packet.ToCall, reference.ToCall) ||
+				!CompareField(mismatch, "Packet::Decode DigiPath", packet.DigiPath, reference.DigiPath) ||
+				!CompareField(mismatch, "Packet::Decode QFlag", packet.QFlag, reference.QFlag) ||
+				!CompareField(mismatch, "Packet::Decode IGate", packet.IGate, reference.IGate) ||
+				!CompareField(mismatch, "Packet::Decode Content", packet.Content, reference.Content))
+			{
+
+				return false;
+			}
+
+			if (!ComparePosition(packet, mismatch))
+			{
+
+				return false;
+			}
+
+			// no fast path yet, decoded for crash and sanitizer coverage
+			Message   message;
+			Object    object;
+			Weather   weather;
+			Status    status;
+			Telemetry telemetry;
+
+			Message::Decode(message, packet);
+			Object::Decode(object, packet);
+			Weather::Decode(weather, packet);
+			Status::Decode(status, packet);
+			Telemetry::Decode(telemetry, packet);
+
+			return true;
+		}
+		// @param lpBuffer raw fuzzer input, treated as a single line
+		// @return false on mismatch
+		static bool Compare(const AL::String::Char* lpBuffer, AL::size_t size, AL::String& mismatch)
+		{
+			return Compare(AL::String(lpBuffer, size), mismatch);
+		}
+
+		// Compares every line of a seed corpus
+		// @return number of mismatches
+		static AL::size_t CompareCorpus(const AL::String::Char* lpBuffer, AL::size_t size, const DecoderDifferentialCallback& callback)
+		{
+			TokenizerLine lines[64];
+			AL::size_t    mismatches = 0;
+			AL::String    mismatch;
+
+			for (AL::size_t offset = 0; offset < size; )
+			{
+				AL::size_t consumed;
+				auto       count = Tokenizer::Tokenize(&lpBuffer[offset], size - offset, lines, sizeof(lines) / sizeof(lines[0]), consumed);
+
+				if (count == 0)
+				{
+					// trailing line without a terminator
+					lines[0].Offset = 0;
+					lines[0].Length = size - offset;
+					consumed        = size - offset;
+					count           = 1;
+				}
+
+				for (AL::size_t i = 0; i < count; ++i)
+				{
+					AL::String line(&lpBuffer[offset + lines[i].Offset], lines[i].Length);
+
+					if (!Compare(line, mismatch))
+					{
+						++mismatches;
+
+						if (!callback(line, mismatch))
+						{
+
+							return mismatches;
+						}
+					}
+				}
+
+				offset += consumed;
+			}
+
+			return mismatches;
+		}
+
+	private:
+		// DecodeCoordinates accepts every position the reference accepts and may accept more
+		static bool ComparePosition(const Packet& packet, AL::String& mismatch)
+		{
+			Position reference;
+
+			if (!Position::Decode(reference, packet))
+			{
+
+				return true;
+			}
+
+			AL::Float        latitude, longitude;
+			AL::String::Char table, key;
+
+			if (!Position::DecodeCoordinates(&packet.Content.GetCString()[1], latitude, longitude, table, key))
+			{
+				mismatch = "Position::DecodeCoordinates returned false";
+
+				return false;
+			}
+
+			if ((Position::ToFixedPoint(latitude) != Position::ToFixedPoint(reference.Latitude)) ||
+				(Position::ToFixedPoint(longitude) != Position::ToFixedPoint(reference.Longitude)))
+			{
+				mismatch = "Position::DecodeCoordinates Latitude/Longitude";
+
+				return false;
+			}
+
+			if ((table != reference.SymbolTable) || (key != reference.SymbolTableKey))
+			{
+				mismatch = "Position::DecodeCoordinates SymbolTable/SymbolTableKey";
+
+				return false;
+			}
+
+			return true;
+		}
+
+		static bool CompareField(AL::String& mismatch, const char* lpField, const AL::String& value, const AL::String& reference)
+		{
+			if (!value.Compare(reference))
+			{
+				mismatch = AL::String::Format("%s '%s' != '%s'", lpField, value.GetCString(), reference.GetCString());
+
+				return false;
+			}
+
+			return true;
+		}
+	};
+
+	namespace IS
+	{
+		typedef AL::Function<void()>                                                     ClientOnMessageSentCallback;
+
+		typedef AL::EventHandler<void()>                                                 ClientOnConnectEventHandler;
+		typedef AL::EventHandler<void()>                                                 ClientOnDisconnectEventHandler;
+		typedef AL::EventHandler<void(const Packet& packet)>                             ClientOnReceivePacketEventHandler;
+		typedef AL::EventHandler<void(const Packet& packet, const Message& message)>     ClientOnReceiveMessageEventHandler;
+		typedef AL::EventHandler<void(const Packet& packet, const Position& position)>   ClientOnReceivePositionEventHandler;
+		typedef AL::EventHandler<void(const Packet& packet, const Weather& weather)>     ClientOnReceiveWeatherEventHandler;
+		typedef AL::EventHandler<void(const Packet& packet, const Telemetry& telemetry)> ClientOnReceiveTelemetryEventHandler;
+		typedef AL::EventHandler<void(const Packet& packet, const Status& status)>       ClientOnReceiveStatusEventHandler;
+		typedef AL::EventHandler<void(const Packet& packet, const Object& object)>       ClientOnReceiveObjectEventHandler;
+		typedef AL::EventHandler<void(const AL::String& comment)>                        ClientOnReceiveServerCommentEventHandler;
+
+		// Splits a byte stream into lines terminated by CRLF or a bare LF
+		// TSource must provide bool Receive(void* lpBuffer, AL::size_t size, AL::size_t& numberOfBytesReceived)
+		// with the semantics of AL::Network::TcpSocket::Receive so framing can be driven without a socket
+		// Lines longer than the maximum line length are dropped and the reader resynchronizes on the next LF.
+		template<typename TSource>
+		class LineReader
+		{
+			TSource*         lpSource;
+
+			AL::String::Char buffer[4096];
+			AL::size_t       bufferBegin = 0;
+			AL::size_t       bufferEnd   = 0;
+			AL::String       lineBuffer;
+
+			bool             isDiscarding = false;
+			AL::size_t       dropCount    = 0;
+			AL::size_t       maxLineLength;
+
+			LineReader(LineReader&&) = delete;
+			LineReader(const LineReader&) = delete;
+
+		public:
+			// APRS-IS servers drop packets longer than 512 bytes
+			static constexpr AL::size_t DEFAULT_MAX_LINE_LENGTH = 512;
+
+			explicit LineReader(TSource& source, AL::size_t maxLineLength = DEFAULT_MAX_LINE_LENGTH)
+				: lpSource(
+					&source
+				),
+				maxLineLength(
+					maxLineLength
+				)
+			{
+			}
+
+			// @return number of lines dropped for exceeding the maximum line length
+			auto GetDropCount() const
+			{
+				return dropCount;
+			}
+
+			auto GetMaxLineLength() const
+			{
+				return maxLineLength;
+			}
+
+			// @param value maximum length excluding the line terminator
+			void SetMaxLineLength(AL::size_t value)
+			{
+				maxLineLength = value;
+			}
+
+			// Discards any buffered data
+			void Reset()
+			{
+				bufferBegin  = 0;
+				bufferEnd    = 0;
+				isDiscarding = false;
+
+				lineBuffer.Clear();
+			}
+
+			// @throw AL::Exception
+			// @return 0 on end of stream
+			// @return -1 if would block
+			int ReadLine(AL::String& value, bool block)
+			{
+				value.Clear();
+
+				// partial lines are kept in lineBuffer until the terminator arrives
+				for (;;)
+				{
+					if (bufferBegin < bufferEnd)
+					{
+						auto size   = bufferEnd - bufferBegin;
+						auto lpLine = &buffer[bufferBegin];
+						auto offset = Tokenizer::Find(lpLine, size, '\n');
+
+						if (offset != size)
+						{
+							bufferBegin += offset + 1;
+
+							if (isDiscarding)
+							{
+								isDiscarding = false;
+
+								continue;
+							}
+
+							if (lineBuffer.GetLength() == 0)
+							{
+								if ((offset != 0) && (lpLine[offset - 1] == '\r'))
+								{
+
+									--offset;
+								}
+
+								if (offset > maxLineLength)
+								{
+									++dropCount;
+
+									continue;
+								}
+
+								value = AL::String(lpLine, offset);
+
+								return 1;
+							}
+
+							lineBuffer.Append(lpLine, offset);
+
+							auto length = lineBuffer.GetLength();
+
+							if (lineBuffer.GetCString()[length - 1] == '\r')
+							{
+
+								lineBuffer.Erase(--length, 1);
+							}
+
+							if (length > maxLineLength)
+							{
+								lineBuffer.Clear();
+								++dropCount;
+
+								continue;
+							}
+
+							value = AL::Move(lineBuffer);
+							lineBuffer.Clear();
+
+							return 1;
+						}
+
+						if (!isDiscarding)
+						{
+							// allow for the '\r' of a line at the limit
+							if ((lineBuffer.GetLength() + size) > (maxLineLength + 1))
+							{
+								lineBuffer.Clear();
+								isDiscarding = true;
+								++dropCount;
+							}
+							else
+							{
+
+								lineBuffer.Append(lpLine, size);
+							}
+						}
+					}
+
+					bufferBegin = 0;
+					bufferEnd   = 0;
+
+					AL::size_t numberOfBytesReceived;
+
+					if (!lpSource->Receive(buffer, sizeof(buffer), numberOfBytesReceived))
+					{
+
+						return 0;
+					}
+
+					if (numberOfBytesReceived == 0)
+					{
+						if (!block)
+						{
+
+							return -1;
+						}
+
+						continue;
+					}
+
+					bufferEnd = numberOfBytesReceived;
+				}
+			}
+		};
+
+		// Lock-free multi-producer single-consumer queue
+		// Producers push onto an atomic stack. The consumer detaches the whole stack with a single
+		// exchange and reverses it into submission order, so producers only ever contend with each other.
+		template<typename T>
+		class ConcurrentQueue
+		{
+			struct _Node
+			{
+				_Node* lpNext;
+				T      Value;
+			};
+
+			std::atomic<_Node*> lpHead;
+			// values left over by a DequeueAll callback that threw, oldest first, consumer only
+			_Node*              lpPending = nullptr;
+
+			ConcurrentQueue(ConcurrentQueue&&) = delete;
+			ConcurrentQueue(const ConcurrentQueue&) = delete;
+
+		public:
+			ConcurrentQueue()
+				: lpHead(
+					nullptr
+				)
+			{
+			}
+
+			virtual ~ConcurrentQueue()
+			{
+				Delete(lpPending);
+				Delete(lpHead.exchange(nullptr, std::memory_order_acquire));
+			}
+
+			// Note: exact only on the consumer thread
+			bool IsEmpty() const
+			{
+				return (lpPending == nullptr) && (lpHead.load(std::memory_order_relaxed) == nullptr);
+			}
+
+			// Note: safe to call from any thread
+			void Enqueue(T&& value)
+			{
+				auto lpNode = new _Node
+				{
+					.lpNext = lpHead.load(std::memory_order_relaxed),
+					.Value  = AL::Move(value)
+				};
+
+				while (!lpHead.compare_exchange_weak(lpNode->lpNext, lpNode, std::memory_order_release, std::memory_order_relaxed))
+				{
+				}
+			}
+
+			// Calls callback with every value queued so far, oldest first
+			// Note: must only be called from the consumer thread
+			// Note: if callback throws, the value it was given is dropped and later values stay queued
+			// @throw AL::Exception
+			// @return number of values dequeued
+			template<typename F>
+			AL::size_t DequeueAll(F&& callback)
+			{
+				_Node* lpFirst = nullptr;
+
+				for (auto lpNode = lpHead.exchange(nullptr, std::memory_order_acquire); lpNode != nullptr; )
+				{
+					auto lpNext    = lpNode->lpNext;
+					lpNode->lpNext = lpFirst;
+					lpFirst        = lpNode;
+					lpNode         = lpNext;
+				}
+
+				// values left over from a previous call are older
+				if (lpPending != nullptr)
+				{
+					auto lpLast = lpPending;
+
+					while (lpLast->lpNext != nullptr)
+					{
+
+						lpLast = lpLast->lpNext;
+					}
+
+					lpLast->lpNext = lpFirst;
+					lpFirst        = lpPending;
+					lpPending      = nullptr;
+				}
+
+				AL::size_t count = 0;
+
+				for (; lpFirst != nullptr; ++count)
+				{
+					auto lpNext = lpFirst->lpNext;
+
+					try
+					{
+						callback(lpFirst->Value);
+					}
+					catch (AL::Exception&)
+					{
+						delete lpFirst;
+						lpPending = lpNext;
+
+						throw;
+					}
+
+					delete lpFirst;
+					lpFirst = lpNext;
+				}
+
+				return count;
+			}
+
+		private:
+			static void Delete(_Node* lpNode)
+			{
+				while (lpNode != nullptr)
+				{
+					auto lpNext = lpNode->lpNext;
+					delete lpNode;
+					lpNode = lpNext;
+				}
+			}
+		};
+
+		// Tracks outstanding messages keyed on (destination, id) in a FlatMap
+		// Destinations are interned so each key is a single 64-bit value. Ids of up to 5 alphanumeric
+		// characters (the APRS limit) pack losslessly, longer or non-conforming ids are hashed.
+		// Destinations match case-insensitively, like the addressee check in Client::Update.
+		template<typename T>
+		class MessageTracker
+		{
+			CallsignTable                          destinations;
+			AL::Collections::ArrayList<AL::uint16> nextIds;
+			FlatMap<T>                             messages;
+
+		public:
+			// ids are 2 base-36 characters so they fit the {MM}AA reply-ack format
+			static constexpr AL::size_t ID_LENGTH = 2;
+			static constexpr AL::uint16 ID_COUNT  = 36 * 36;
+
+			// longer destinations are matched as given
+			static constexpr AL::size_t MAX_DESTINATION_LENGTH = 16;
+
+			AL::size_t GetSize() const
+			{
+				return messages.GetSize();
+			}
+
+			// Skips ids still outstanding for destination, ids repeat after ID_COUNT allocations
+			// @throw AL::Exception if all ID_COUNT ids are outstanding
+			// @return next free id for destination
+			AL::String AllocateId(const AL::String& destination)
+			{
+				static constexpr AL::String::Char DIGITS[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+				AL::String::Char destinationBuffer[MAX_DESTINATION_LENGTH];
+				auto             destinationId = destinations.Intern(Normalize(destinationBuffer, destination), destination.GetLength());
+
+				while (nextIds.GetSize() <= destinationId)
+				{
+
+					nextIds.PushBack(0);
+				}
+
+				for (AL::uint16 i = 0; i < ID_COUNT; ++i)
+				{
+					auto id = nextIds[destinationId];
+					nextIds[destinationId] = (id + 1) % ID_COUNT;
+
+					AL::String::Char buffer[ID_LENGTH] =
+					{
+						DIGITS[id / 36],
+						DIGITS[id % 36]
+					};
+
+					if (messages.Find(MakeKey(destinationId, buffer, ID_LENGTH)) == nullptr)
+					{
+
+						return AL::String(buffer, ID_LENGTH);
+					}
+				}
+
+				throw AL::Exception(
+					"No free message id for %s",
+					destination.GetCString()
+				);
+			}
+
+			// @return nullptr if not found
+			T* Find(const AL::String& destination, const AL::String& id)
+			{
+				auto destinationId = FindDestination(destination);
+
+				if (destinationId == CallsignTable::INVALID_ID)
+				{
+
+					return nullptr;
+				}
+
+				return messages.Find(MakeKey(destinationId, id));
+			}
+
+			// @return existing or default constructed value
+			T& Insert(const AL::String& destination, const AL::String& id)
+			{
+				AL::String::Char destinationBuffer[MAX_DESTINATION_LENGTH];
+
+				return messages.Insert(MakeKey(destinations.Intern(Normalize(destinationBuffer, destination), destination.GetLength()), id));
+			}
+
+			// @return false if not found
+			bool Remove(const AL::String& destination, const AL::String& id)
+			{
+				auto destinationId = FindDestination(destination);
+
+				if (destinationId == CallsignTable::INVALID_ID)
+				{
+
+					return false;
+				}
+
+				return messages.Remove(MakeKey(destinationId, id));
+			}
+
+			// Removes every outstanding message
+			// Note: ids already allocated are not reused
+			void Clear()
+			{
+				messages.Clear();
+			}
+
+		private:
+			AL::uint32 FindDestination(const AL::String& destination) const
+			{
+				AL::String::Char destinationBuffer[MAX_DESTINATION_LENGTH];
+
+				return destinations.Find(Normalize(destinationBuffer, destination), destination.GetLength());
+			}
+
+			// @return destination upper-cased into buffer, or as given if longer than MAX_DESTINATION_LENGTH
+			static const AL::String::Char* Normalize(AL::String::Char(&buffer)[MAX_DESTINATION_LENGTH], const AL::String& destination)
+			{
+				auto lpDestination = destination.GetCString();
+				auto length        = destination.GetLength();
+
+				if (length > MAX_DESTINATION_LENGTH)
+				{
+
+					return lpDestination;
+				}
+
+				for (AL::size_t i = 0; i < length; ++i)
+				{
+					auto c = lpDestination[i];
+
+					buffer[i] = ((c >= 'a') && (c <= 'z')) ? static_cast<AL::String::Char>(c - 'a' + 'A') : c;
+				}
+
+				return buffer;
+			}
+
+			// destination id + 1 in the high 32 bits so no key is 0
+			static AL::uint64 MakeKey(AL::uint32 destinationId, const AL::String& id)
+			{
+				return MakeKey(destinationId, id.GetCString(), id.GetLength());
+			}
+			static AL::uint64 MakeKey(AL::uint32 destinationId, const AL::String::Char* lpId, AL::size_t length)
+			{
+				return (static_cast<AL::uint64>(destinationId + 1) << 32) | PackId(lpId, length);
+			}
+
+			static AL::uint32 PackId(const AL::String::Char* lpId, AL::size_t length)
+			{
+				if (length <= 5)
+				{
+					AL::uint32 value = 0;
+
+					for (AL::size_t i = 0; i < length; ++i)
+					{
+						auto c = lpId[i];
+
+						if      ((c >= '0') && (c <= '9')) value = (value << 6) | (c - '0' + 1);
+						else if ((c >= 'A') && (c <= 'Z')) value = (value << 6) | (c - 'A' + 11);
+						else if ((c >= 'a') && (c <= 'z')) value = (value << 6) | (c - 'a' + 37);
+						else                               return CallsignTable::Hash(lpId, length) | 0x80000000;
+					}
+
+					return value;
+				}
+
+				return CallsignTable::Hash(lpId, length) | 0x80000000;
+			}
+		};
+
+		// Allows Rate tokens per second on average and at most Burst at once
+		class TokenBucket
+		{
+			AL::Double   rate;
+			AL::Double   burst;
+			AL::Double   tokens;
+			AL::TimeSpan lastUpdate;
+
+		public:
+			// @param rate 0 or less for unlimited
+			// @param burst clamped to 1 so a single packet can always be sent
+			explicit TokenBucket(AL::Double rate = 0, AL::Double burst = 1)
+				: rate(
+					(rate > 0) ? rate : 0
+				),
+				burst(
+					(burst > 1) ? burst : 1
+				),
+				tokens(
+					this->burst
+				)
+			{
+			}
+
+			bool IsUnlimited() const
+			{
+				return rate <= 0;
+			}
+
+			auto GetRate() const
+			{
+				return rate;
+			}
+
+			auto GetBurst() const
+			{
+				return burst;
+			}
+
+			auto GetTokens() const
+			{
+				return tokens;
+			}
+
+			// Refills the bucket to Burst
+			void Reset(AL::TimeSpan now)
+			{
+				tokens     = burst;
+				lastUpdate = now;
+			}
+
+			// @param now monotonic time
+			void Update(AL::TimeSpan now)
+			{
+				if (now > lastUpdate)
+				{
+					tokens    += (rate * (now - lastUpdate).ToMicroseconds()) / 1000000;
+					lastUpdate = now;
+
+					if (tokens > burst)
+					{
+
+						tokens = burst;
+					}
+				}
+			}
+
+			// @return false if not enough tokens are available
+			bool TryConsume(AL::Double count = 1)
+			{
+				if (IsUnlimited())
+				{
+
+					return true;
+				}
+
+				if (tokens < count)
+				{
+
+					return false;
+				}
+
+				tokens -= count;
+
+				return true;
+			}
+		};
+
+		// Outbound traffic classes, highest priority first
+		enum class ClientSendPriorities : AL::uint8
+		{
+			Ack,
+			Reply,
+			Beacon
+		};
+
+		enum class ClientDecodeFlags : AL::uint8
+		{
+			None      = 0x00,
+			Message   = 0x01,
+			Position  = 0x02,
+			Weather   = 0x04,
+			Telemetry = 0x08,
+			Status    = 0x10,
+			Object    = 0x20,
+
+			All       = Message | Position | Weather | Telemetry | Status | Object
+		};
+
+		constexpr ClientDecodeFlags operator | (ClientDecodeFlags a, ClientDecodeFlags b)
+		{
+			return static_cast<ClientDecodeFlags>(static_cast<AL::uint8>(a) | static_cast<AL::uint8>(b));
+		}
+
+		constexpr ClientDecodeFlags operator & (ClientDecodeFlags a, ClientDecodeFlags b)
+		{
+			return static_cast<ClientDecodeFlags>(static_cast<AL::uint8>(a) & static_cast<AL::uint8>(b));
+		}
+
+		// Default Client policy: virtual hooks and AL::Event handlers
+		class ClientPolicy
+		{
+		public:
+			static constexpr ClientDecodeFlags DECODE_FLAGS = ClientDecodeFlags::All;
+
+			// @throw AL::Exception
+			AL::Event<ClientOnConnectEventHandler>              OnConnect;
+			AL::Event<ClientOnDisconnectEventHandler>           OnDisconnect;
+
+			// @throw AL::Exception
+			AL::Event<ClientOnReceivePacketEventHandler>        OnReceivePacket;
+			// @throw AL::Exception
+			AL::Event<ClientOnReceiveMessageEventHandler>       OnReceiveMessage;
+			// @throw AL::Exception
+			AL::Event<ClientOnReceivePositionEventHandler>      OnReceivePosition;
+			// @throw AL::Exception
+			AL::Event<ClientOnReceiveWeatherEventHandler>       OnReceiveWeather;
+			// @throw AL::Exception
+			AL::Event<ClientOnReceiveTelemetryEventHandler>     OnReceiveTelemetry;
+			// @throw AL::Exception
+			AL::Event<ClientOnReceiveStatusEventHandler>        OnReceiveStatus;
+			// @throw AL::Exception
+			// Note: objects and items
+			AL::Event<ClientOnReceiveObjectEventHandler>        OnReceiveObject;
+
+			// @throw AL::Exception
+			// Note: lines starting with '#' including keepalives and the login response
+			AL::Event<ClientOnReceiveServerCommentEventHandler> OnReceiveServerComment;
+
+			virtual ~ClientPolicy()
+			{
+			}
+
+		protected:
+			// @throw AL::Exception
+			// @return false to stop processing
+			virtual bool OnReadPacket(const Packet& packet)
+			{
+				return true;
+			}
+
+			// @throw AL::Exception
+			// @return false to stop processing
+			virtual bool OnReadMessage(const Packet& packet, const Message& message)
+			{
+				return true;
+			}
+
+			// @throw AL::Exception
+			// @return false to stop processing
+			virtual bool OnReadPosition(const Packet& packet, const Position& position)
+			{
+				return true;
+			}
+
+			// @throw AL::Exception
+			void OnConnected()
+			{
+				OnConnect.Execute();
+			}
+
+			void OnDisconnected()
+			{
+				OnDisconnect.Execute();
+			}
+
+			// @throw AL::Exception
+			void OnPacketReceived(const Packet& packet)
+			{
+				OnReceivePacket.Execute(packet);
+			}
+
+			// @throw AL::Exception
+			void OnMessageReceived(const Packet& packet, const Message& message)
+			{
+				OnReceiveMessage.Execute(packet, message);
+			}
+
+			// @throw AL::Exception
+			void OnPositionReceived(const Packet& packet, const Position& position)
+			{
+				OnReceivePosition.Execute(packet, position);
+			}
+
+			// @throw AL::Exception
+			void OnWeatherReceived(const Packet& packet, const Weather& weather)
+			{
+				OnReceiveWeather.Execute(packet, weather);
+			}
+
+			// @throw AL::Exception
+			void OnTelemetryReceived(const Packet& packet, const Telemetry& telemetry)
+			{
+				OnReceiveTelemetry.Execute(packet, telemetry);
+			}
+
+			// @throw AL::Exception
+			void OnStatusReceived(const Packet& packet, const Status& status)
+			{
+				OnReceiveStatus.Execute(packet, status);
+			}
+
+			// @throw AL::Exception
+			void OnObjectReceived(const Packet& packet, const Object& object)
+			{
+				OnReceiveObject.Execute(packet, object);
+			}
+
+			// @throw AL::Exception
+			void OnServerCommentReceived(const AL::String& comment)
+			{
+				OnReceiveServerComment.Execute(comment);
+			}
+		};
+
+		template<typename TPolicy>
+		class BasicClient;
+
+		// Base for compile-time policies: no decoding and inline no-op hooks
+		// Derived policies pass themselves as TDerived and shadow DECODE_FLAGS and only
+		// the hooks they need, e.g.
+		//	struct PositionLogger : APRS::IS::BasicClientPolicy<PositionLogger>
+		//	{
+		//		static constexpr ClientDecodeFlags DECODE_FLAGS = ClientDecodeFlags::Position;
+		//		void OnPositionReceived(const Packet& packet, const Position& position) { GetClient().SendMessage(...); }
+		//	};
+		//	APRS::IS::BasicClient<PositionLogger> client(...);
+		template<typename TDerived>
+		class BasicClientPolicy
+		{
+		public:
+			static constexpr ClientDecodeFlags DECODE_FLAGS = ClientDecodeFlags::None;
+
+		protected:
+			// @return the client this policy is the base of
+			BasicClient<TDerived>& GetClient()
+			{
+				return static_cast<BasicClient<TDerived>&>(*this);
+			}
+			// @return the client this policy is the base of
+			const BasicClient<TDerived>& GetClient() const
+			{
+				return static_cast<const BasicClient<TDerived>&>(*this);
+			}
+
+			bool OnReadPacket(const Packet& packet)
+			{
+				return true;
+			}
+
+			bool OnReadMessage(const Packet& packet, const Message& message)
+			{
+				return true;
+			}
+
+			bool OnReadPosition(const Packet& packet, const Position& position)
+			{
+				return true;
+			}
+
+			void OnConnected()
+			{
+			}
+
+			void OnDisconnected()
+			{
+			}
+
+			void OnPacketReceived(const Packet& packet)
+			{
+			}
+
+			void OnMessageReceived(const Packet& packet, const Message& message)
+			{
+			}
+
+			void OnPositionReceived(const Packet& packet, const Position& position)
+			{
+			}
+
+			void OnWeatherReceived(const Packet& packet, const Weather& weather)
+			{
+			}
+
+			void OnTelemetryReceived(const Packet& packet, const Telemetry& telemetry)
+			{
+			}
+
+			void OnStatusReceived(const Packet& packet, const Status& status)
+			{
+			}
+
+			void OnObjectReceived(const Packet& packet, const Object& object)
+			{
+			}
+
+			void OnServerCommentReceived(const AL::String& comment)
+			{
+			}
+		};
+
+		// TPolicy supplies the decode set (DECODE_FLAGS), the filter stages (OnRead*)
+		// and the handlers (On*Received). Hooks are resolved at compile time, so they
+		// only dispatch virtually when the policy declares them virtual (ClientPolicy).
+		// The client derives from its policy rather than the other way around, so the
+		// policy reaches the client through BasicClientPolicy::GetClient.
+		template<typename TPolicy>
+		class BasicClient
+			: public TPolicy
+		{
+			class Connection
+			{
+				AL::Network::TcpSocket             socket;
+				AL::Network::IPEndPoint            remoteEP;
+				LineReader<AL::Network::TcpSocket> reader;
+
+			public:
+				explicit Connection(const AL::Network::IPEndPoint& remoteEP)
+					: socket(
+						remoteEP.Host.GetFamily()
+					),
+					remoteEP(
+						remoteEP
+					),
+					reader(
+						socket
+					)
+				{
+				}
+
+				virtual ~Connection()
+				{
+					if (IsOpen())
+					{
+
+						Close();
+					}
+				}
+
+				bool IsBlocking() const
+				{
+					return socket.IsBlocking();
+				}
+
+				bool IsOpen() const
+				{
+					return socket.IsConnected();
+				}
+
+				// @throw AL::Exception
+				void Open()
+				{
+					AL_ASSERT(
+						!IsOpen(),
+						"Connection already open"
+					);
+
+					try
+					{
+						socket.Open();
+
+						try
+						{
+							if (!socket.Connect(remoteEP))
+							{
+
+								throw AL::Exception(
+									"Connection timed out"
+								);
+							}
+						}
+						catch (AL::Exception&)
+						{
+							socket.Close();
+
+							throw;
+						}
+					}
+					catch (AL::Exception& exception)
+					{
+
+						throw AL::Exception(
+							"Error connecting to %s:%u",
+							remoteEP.Host.ToString().GetCString(),
+							remoteEP.Port
+						);
+					}
+				}
+
+				void Close()
+				{
+					socket.Close();
+				}
+
+				// @throw AL::Exception
+				void SetBlocking(bool value)
+				{
+					socket.SetBlocking(value);
+				}
+
+				auto GetDropCount() const
+				{
+					return reader.GetDropCount();
+				}
+
+				void SetMaxLineLength(AL::size_t value)
+				{
+					reader.SetMaxLineLength(value);
+				}
+
+				// @throw AL::Exception
+				// @return 0 on connection closed
+				// @return -1 if would block
+				int ReadLine(AL::String& value, bool block)
+				{
+					AL_ASSERT(
+						IsConnected(),
+						"Connection not open"
+					);
+
+					try
+					{
+						auto result = reader.ReadLine(value, block);
+
+						if (result == 0)
+						{
+
+							Close();
+						}
+
+						return result;
+					}
+					catch (AL::Exception&)
+					{
+						Close();
+
+						throw;
+					}
+				}
+
+				// @throw AL::Exception
+				// @return false on connection closed
+				bool Write(const void* lpBuffer, AL::size_t size)
+				{
+					AL_ASSERT(
+						IsConnected(),
+						"Connection not open"
+					);
+
+					AL::size_t numberOfBytesSent;
+
+					try
+					{
+						if (!AL::Network::SocketExtensions::SendAll(socket, lpBuffer, size, numberOfBytesSent))
+						{
+							Close();
+
+							return false;
+						}
+					}
+					catch (AL::Exception&)
+					{
+						Close();
+
+						throw;
+					}
+
+					return true;
+				}
+
+				// @throw AL::Exception
+				// @return false on connection closed
+				bool WriteLine(const AL::String& value)
+				{
+					AL_ASSERT(
+						IsConnected(),
+						"Connection not open"
+					);
+
+					auto valueLength = value.GetLength();
 
 					if (valueLength > 510)
 					{
 
-						valueLength = 510;
+						valueLength = 510;
+					}
+
+					AL::size_t numberOfBytesSent;
+
+					static constexpr char EOL[] = "\r\n";
+
+					try
+					{
+						if (!AL::Network::SocketExtensions::SendAll(socket, value.GetCString(), valueLength, numberOfBytesSent) ||
+							!AL::Network::SocketExtensions::SendAll(socket, EOL, sizeof(EOL) - 1, numberOfBytesSent))
+						{
+							Close();
+
+							return false;
+						}
+					}
+					catch (AL::Exception&)
+					{
+						Close();
+
+						throw;
+					}
+
+					return true;
+				}
+			};
+
+			typedef AL::Collections::Queue<ClientOnMessageSentCallback>               _MessageAckCallbackQueue;
+			typedef MessageTracker<_MessageAckCallbackQueue>                          _MessageAckCallbacks;
+
+			struct _QueuedPacket
+			{
+				// encoded without line terminator or message id
+				AL::String                  Line;
+				ClientSendPriorities        Priority;
+
+				bool                        HasCallback;
+				// allocated when the packet is written if empty
+				AL::String                  Ack;
+				AL::String                  ReplyAck;
+				AL::String                  Destination;
+				ClientOnMessageSentCallback Callback;
+			};
+
+			typedef ConcurrentQueue<_QueuedPacket>                                    _SendQueue;
+			typedef AL::Collections::Queue<_QueuedPacket>                             _SendPriorityQueue;
+			typedef AL::Collections::ArrayList<_QueuedPacket>                         _SendBatch;
+
+			static constexpr AL::size_t SEND_PRIORITY_COUNT = static_cast<AL::size_t>(ClientSendPriorities::Beacon) + 1;
+
+			bool                    isBlocking  = false;
+			bool                    isConnected = false;
+
+			ClientDecodeFlags       decodeFlags = ClientDecodeFlags::All;
+
+			AL::size_t              maxLineLength    = LineReader<AL::Network::TcpSocket>::DEFAULT_MAX_LINE_LENGTH;
+			AL::size_t              droppedLineCount = 0;
+
+			AL::String              filter;
+			AL::String              callsign;
+			AL::uint16              passcode;
+			AL::String              readBuffer;
+			AL::String              writeBuffer;
+			Connection*             lpConnection;
+			_MessageAckCallbacks    messageCallbacks;
+			_SendQueue              sendQueue;
+			_SendPriorityQueue      sendPriorityQueues[SEND_PRIORITY_COUNT];
+			AL::size_t              sendPendingCount = 0;
+			TokenBucket             sendRateLimit;
+			// packets with callbacks in the current write, registered once it succeeds
+			_SendBatch              sendBatch;
+
+			// monotonic clock for the rate limit, stall detection and station store, read once per Update
+			AL::OS::Timer           timer;
+			AL::TimeSpan            lastReceiveTime;
+			AL::TimeSpan            stallTimeout    = AL::TimeSpan::FromSeconds(60);
+			bool                    isAutoReconnect = false;
+			bool                    isVerified      = false;
+			AL::String              serverName;
+			AL::Network::IPEndPoint remoteEP;
+
+			StationStore*           lpStationStore = nullptr;
+
+			BasicClient(BasicClient&&) = delete;
+			BasicClient(const BasicClient&) = delete;
+
+		public:
+			BasicClient(AL::String&& callsign, AL::uint16 passcode, AL::String&& filter)
+				: filter(
+					AL::Move(filter)
+				),
+				callsign(
+					AL::Move(callsign)
+				),
+				passcode(
+					passcode
+				)
+			{
+			}
+
+			virtual ~BasicClient()
+			{
+				if (IsConnected())
+				{
+
+					Disconnect();
+				}
+			}
+
+			bool IsBlocking() const
+			{
+				return isBlocking;
+			}
+
+			bool IsConnected() const
+			{
+				return isConnected;
+			}
+
+			auto& GetFilter() const
+			{
+				return filter;
+			}
+
+			auto& GetCallsign() const
+			{
+				return callsign;
+			}
+
+			auto GetDecodeFlags() const
+			{
+				return decodeFlags;
+			}
+
+			// Note: only flags also set in TPolicy::DECODE_FLAGS take effect
+			// Note: messages are still decoded to match acks for pending SendMessage callbacks
+			void SetDecodeFlags(ClientDecodeFlags value)
+			{
+				decodeFlags = value;
+			}
+
+			// @return monotonic time since the client was constructed
+			AL::TimeSpan GetTime() const
+			{
+				return timer.GetElapsed();
+			}
+
+			auto GetStationStore() const
+			{
+				return lpStationStore;
+			}
+
+			// Updates lpValue with every packet that passes OnReadPacket
+			// Note: timestamps are GetTime().ToMicroseconds() at the Update that read the packet
+			// @param lpValue nullptr to disable
+			void SetStationStore(StationStore* lpValue)
+			{
+				lpStationStore = lpValue;
+			}
+
+			// @return name reported by the server in the login response
+			auto& GetServerName() const
+			{
+				return serverName;
+			}
+
+			bool IsVerified() const
+			{
+				return isVerified;
+			}
+
+			auto GetStallTimeout() const
+			{
+				return stallTimeout;
+			}
+
+			// Disconnects when nothing (including server keepalives) is received for value
+			// Note: only checked when Update finds no data, a blocking client waits in
+			// TcpSocket::Receive on a half-open connection and never detects the stall
+			// Also bounds the wait for the login response in Connect
+			// @param value 0 to disable stall detection
+			void SetStallTimeout(AL::TimeSpan value)
+			{
+				stallTimeout = value;
+			}
+
+			bool IsAutoReconnect() const
+			{
+				return isAutoReconnect;
+			}
+
+			// Reconnects to the last server after a stall instead of returning false from Update
+			// Note: requires a non-blocking client, see SetStallTimeout
+			void SetAutoReconnect(bool value)
+			{
+				isAutoReconnect = value;
+			}
+
+			auto GetMaxLineLength() const
+			{
+				return maxLineLength;
+			}
+
+			// @param value lines longer than this (excluding the terminator) are dropped
+			void SetMaxLineLength(AL::size_t value)
+			{
+				maxLineLength = value;
+
+				if (IsConnected())
+				{
+
+					lpConnection->SetMaxLineLength(value);
+				}
+			}
+
+			// @return number of lines dropped for exceeding the maximum line length
+			AL::size_t GetDroppedLineCount() const
+			{
+				return IsConnected() ? (droppedLineCount + lpConnection->GetDropCount()) : droppedLineCount;
+			}
+
+			// Note: stall detection and auto reconnect only work in non-blocking mode
+			// @throw AL::Exception
+			void SetBlocking(bool value)
+			{
+				isBlocking = value;
+
+				if (IsConnected())
+				{
+					lpConnection->SetBlocking(
+						value
+					);
+				}
+			}
+
+			// @throw AL::Exception
+			void Connect(const AL::Network::IPEndPoint& remoteEP)
+			{
+				AL_ASSERT(
+					!IsConnected(),
+					"Client already connected"
+				);
+
+				lpConnection = new Connection(
+					remoteEP
+				);
+
+				lpConnection->SetMaxLineLength(
+					maxLineLength
+				);
+
+				try
+				{
+					lpConnection->SetBlocking(IsBlocking());
+
+					lpConnection->Open();
+
+					if (!Authenticate())
+					{
+
+						throw AL::Exception(
+							"Authentication failed"
+						);
+					}
+				}
+				catch (AL::Exception&)
+				{
+					delete lpConnection;
+
+					throw;
+				}
+
+				isConnected     = true;
+				lastReceiveTime = timer.GetElapsed();
+				this->remoteEP  = remoteEP;
+
+				try
+				{
+					this->OnConnected();
+				}
+				catch (AL::Exception&)
+				{
+					Disconnect();
+
+					throw;
+				}
+			}
+
+			void Disconnect()
+			{
+				if (IsConnected())
+				{
+					messageCallbacks.Clear();
+
+					droppedLineCount += lpConnection->GetDropCount();
+
+					lpConnection->Close();
+					delete lpConnection;
+
+					isConnected = false;
+
+					this->OnDisconnected();
+				}
+			}
+
+			// @throw AL::Exception
+			// @return false on connection closed
+			bool Update()
+			{
+				AL_ASSERT(
+					IsConnected(),
+					"Client not connected"
+				);
+
+				auto now = timer.GetElapsed();
+
+				if ((!sendQueue.IsEmpty() || (sendPendingCount != 0)) && !FlushSendQueue(now))
+				{
+
+					return false;
+				}
+
+				Packet packet;
+
+				switch (ReadPacket(packet, now))
+				{
+					case 0:
+						return false;
+
+					case -1:
+						if (IsStalled(now))
+						{
+
+							return Reconnect();
+						}
+						return true;
+
+					case -2:
+						return true;
+				}
+
+				if (this->OnReadPacket(packet))
+				{
+					if (lpStationStore != nullptr)
+					{
+
+						lpStationStore->Update(now.ToMicroseconds(), packet);
+					}
+
+					this->OnPacketReceived(packet);
+
+					switch (packet.GetDataType())
+					{
+						case DataTypes::Item:
+						case DataTypes::Object:
+							ReceiveObject(packet);
+							break;
+
+						case DataTypes::Status:
+							ReceiveStatus(packet);
+							break;
+
+						case DataTypes::Message:
+							ReceiveMessage(packet);
+							break;
+
+						case DataTypes::Weather:
+							ReceiveWeather(packet);
+							break;
+
+						case DataTypes::Position:
+							ReceivePosition(packet);
+							break;
+
+						case DataTypes::Telemetry:
+							ReceiveTelemetry(packet);
+							break;
+
+						case DataTypes::Unknown:
+							break;
+					}
+				}
+
+				return true;
+			}
+
+			// @return next message id for destination (2 base-36 characters)
+			// Note: must only be called from the thread calling Update
+			AL::String AllocateMessageId(const AL::String& destination)
+			{
+				return messageCallbacks.AllocateId(destination);
+			}
+
+			// Note: This bypasses automatic ack handling
+			// @throw AL::Exception
+			// @return false on connection closed
+			bool SendPacket(const Packet& value)
+			{
+				AL_ASSERT(
+					IsConnected(),
+					"Client not connected"
+				);
+
+				return WritePacket(value);
+			}
+
+			// @throw AL::Exception
+			// @return false on connection closed
+			bool SendMessage(const Message& value, const AL::String& tocall, const AL::String& path)
+			{
+				AL_ASSERT(
+					IsConnected(),
+					"Client not connected"
+				);
+
+				return WritePacket(value.Encode(tocall, GetCallsign(), path));
+			}
+			// @throw AL::Exception
+			// @return false on connection closed
+			bool SendMessage(const Message& value, const AL::String& tocall, const AL::String& path, ClientOnMessageSentCallback&& callback)
+			{
+				AL_ASSERT(
+					IsConnected(),
+					"Client not connected"
+				);
+
+				if (value.Ack.GetLength() == 0)
+				{
+					auto message = value;
+					message.Ack  = AllocateMessageId(value.Destination);
+
+					return SendMessage(message, tocall, path, AL::Move(callback));
+				}
+
+				if (!WritePacket(value.Encode(tocall, GetCallsign(), path)))
+				{
+
+					return false;
+				}
+
+				messageCallbacks.Insert(value.Destination, value.Ack).Enqueue(AL::Move(callback));
+
+				return true;
+			}
+
+			// @throw AL::Exception
+			// @return false on connection closed
+			bool SendPosition(const Position& value, const AL::String& tocall, const AL::String& path)
+			{
+				AL_ASSERT(
+					IsConnected(),
+					"Client not connected"
+				);
+
+				return WritePacket(value.Encode(tocall, GetCallsign(), path));
+			}
+
+			// @throw AL::Exception
+			// @return false on connection closed
+			bool SendObject(const Object& value, const AL::String& tocall, const AL::String& path)
+			{
+				AL_ASSERT(
+					IsConnected(),
+					"Client not connected"
+				);
+
+				return WritePacket(value.Encode(tocall, GetCallsign(), path));
+			}
+
+			auto& GetRateLimit() const
+			{
+				return sendRateLimit;
+			}
+
+			// Limits queued packets to rate per second on average and burst at once
+			// Note: Send* methods are written immediately and are not limited
+			// @param rate 0 or less to write queued packets as soon as Update runs
+			// @param burst values below 1 are raised to 1
+			void SetRateLimit(AL::Double rate, AL::Double burst)
+			{
+				sendRateLimit = TokenBucket(rate, burst);
+				sendRateLimit.Reset(timer.GetElapsed());
+			}
+
+			// @return number of packets waiting for the rate limit
+			auto GetPendingSendCount() const
+			{
+				return sendPendingCount;
+			}
+
+			// Queues value to be sent by the thread calling Update
+			// Note: safe to call from any thread, including while disconnected
+			// Note: This bypasses automatic ack handling
+			void QueuePacket(const Packet& value, ClientSendPriorities priority = ClientSendPriorities::Reply)
+			{
+				sendQueue.Enqueue(
+					_QueuedPacket
+					{
+						.Line        = value.Encode(),
+						.Priority    = priority,
+						.HasCallback = false
+					}
+				);
+			}
+
+			// Queues an ack for message id received from destination
+			// Note: safe to call from any thread, including while disconnected
+			void QueueAck(const AL::String& destination, const AL::String& id, const AL::String& tocall, const AL::String& path)
+			{
+				Message message =
+				{
+					.Content     = AL::String::Format("ack%s", id.GetCString()),
+					.Destination = destination
+				};
+
+				QueuePacket(message.Encode(tocall, GetCallsign(), path), ClientSendPriorities::Ack);
+			}
+
+			// Queues value to be sent by the thread calling Update
+			// Note: safe to call from any thread, including while disconnected
+			void QueueMessage(const Message& value, const AL::String& tocall, const AL::String& path, ClientSendPriorities priority = ClientSendPriorities::Reply)
+			{
+				QueuePacket(value.Encode(tocall, GetCallsign(), path), priority);
+			}
+			// Queues value to be sent by the thread calling Update
+			// Note: safe to call from any thread, including while disconnected
+			// Note: callback is executed on the thread calling Update once the message is acked
+			// Note: if value.Ack is empty an id is allocated when the message is written
+			void QueueMessage(const Message& value, const AL::String& tocall, const AL::String& path, ClientOnMessageSentCallback&& callback, ClientSendPriorities priority = ClientSendPriorities::Reply)
+			{
+				sendQueue.Enqueue(
+					_QueuedPacket
+					{
+						.Line        = Message { .Content = value.Content, .Destination = value.Destination }.Encode(tocall, GetCallsign(), path).Encode(),
+						.Priority    = priority,
+						.HasCallback = true,
+						.Ack         = value.Ack,
+						.ReplyAck    = value.ReplyAck,
+						.Destination = value.Destination,
+						.Callback    = AL::Move(callback)
+					}
+				);
+			}
+
+			// Queues value to be sent by the thread calling Update
+			// Note: safe to call from any thread, including while disconnected
+			void QueuePosition(const Position& value, const AL::String& tocall, const AL::String& path, ClientSendPriorities priority = ClientSendPriorities::Beacon)
+			{
+				QueuePacket(value.Encode(tocall, GetCallsign(), path), priority);
+			}
+
+			// Queues value to be sent by the thread calling Update
+			// Note: safe to call from any thread, including while disconnected
+			void QueueObject(const Object& value, const AL::String& tocall, const AL::String& path, ClientSendPriorities priority = ClientSendPriorities::Beacon)
+			{
+				QueuePacket(value.Encode(tocall, GetCallsign(), path), priority);
+			}
+
+			// Sends every line of batch with a single write
+			// @throw AL::Exception
+			// @return false on connection closed
+			bool SendBatch(const PacketBatchEncoder& batch)
+			{
+				AL_ASSERT(
+					IsConnected(),
+					"Client not connected"
+				);
+
+				if (batch.GetCount() == 0)
+				{
+
+					return true;
+				}
+
+				try
+				{
+					if (!lpConnection->Write(batch.GetBuffer().GetCString(), batch.GetBuffer().GetLength()))
+					{
+						Disconnect();
+
+						return false;
+					}
+				}
+				catch (AL::Exception& exception)
+				{
+
+					throw AL::Exception(
+						AL::Move(exception),
+						"Error sending batch [Count: %lu]",
+						static_cast<unsigned long>(batch.GetCount())
+					);
+				}
+
+				return true;
+			}
+
+		private:
+			static constexpr bool IsDecodeSupported(ClientDecodeFlags flag)
+			{
+				return (TPolicy::DECODE_FLAGS & flag) != ClientDecodeFlags::None;
+			}
+
+			bool IsDecodeFlagSet(ClientDecodeFlags flag) const
+			{
+				return IsDecodeSupported(flag) && ((decodeFlags & flag) != ClientDecodeFlags::None);
+			}
+
+			// @throw AL::Exception
+			void ReceiveObject(const Packet& packet)
+			{
+				if constexpr (IsDecodeSupported(ClientDecodeFlags::Object))
+				{
+					Object object;
+
+					if (IsDecodeFlagSet(ClientDecodeFlags::Object) && Object::Decode(object, packet))
+					{
+
+						this->OnObjectReceived(packet, object);
+					}
+				}
+			}
+
+			// @throw AL::Exception
+			void ReceiveStatus(const Packet& packet)
+			{
+				if constexpr (IsDecodeSupported(ClientDecodeFlags::Status))
+				{
+					Status status;
+
+					if (IsDecodeFlagSet(ClientDecodeFlags::Status) && Status::Decode(status, packet))
+					{
+
+						this->OnStatusReceived(packet, status);
+					}
+				}
+			}
+
+			// @throw AL::Exception
+			void ReceiveMessage(const Packet& packet)
+			{
+				bool isMessageDecoded = IsDecodeFlagSet(ClientDecodeFlags::Message);
+
+				if (!isMessageDecoded && (messageCallbacks.GetSize() == 0))
+				{
+
+					return;
+				}
+
+				Message message;
+
+				if (Message::Decode(message, packet) && (!isMessageDecoded || this->OnReadMessage(packet, message)))
+				{
+					// acks between other stations can reuse the ids we allocated for the same sender
+					// Message::Decode strips the padding so Destination compares directly
+					bool isAddressedToUs = message.Destination.Compare(GetCallsign(), true);
+
+					// {MM}AA acks our message AA in addition to carrying a new message
+					if (isAddressedToUs && (message.ReplyAck.GetLength() != 0))
+					{
+
+						ExecuteMessageCallback(packet.Sender, message.ReplyAck);
+					}
+
+					// ackMM or ackMM}AA
+					auto lpContent     = message.Content.GetCString();
+					auto contentLength = message.Content.GetLength();
+
+					if (isAddressedToUs && (contentLength > 3) && (::memcmp(lpContent, "ack", 3) == 0))
+					{
+						auto idLength = Tokenizer::Find(&lpContent[3], contentLength - 3, '}');
+
+						if ((idLength != 0) && ExecuteMessageCallback(packet.Sender, AL::String(&lpContent[3], idLength)))
+						{
+
+							return;
+						}
+					}
+
+					if (isMessageDecoded)
+					{
+
+						this->OnMessageReceived(packet, message);
+					}
+				}
+			}
+
+			bool IsStalled(AL::TimeSpan now) const
+			{
+				return (stallTimeout.ToMicroseconds() != 0) && (now > lastReceiveTime) && ((now - lastReceiveTime) >= stallTimeout);
+			}
+
+			// Drops a stalled connection and reconnects if enabled
+			// @throw AL::Exception
+			// @return false on connection closed or if reconnecting failed
+			bool Reconnect()
+			{
+				Disconnect();
+
+				if (!IsAutoReconnect())
+				{
+
+					return false;
+				}
+
+				try
+				{
+					Connect(remoteEP);
+				}
+				catch (AL::Exception&)
+				{
+
+					return false;
+				}
+
+				return true;
+			}
+
+			// @throw AL::Exception
+			// @return false if no message to destination with id is outstanding
+			bool ExecuteMessageCallback(const AL::String& destination, const AL::String& id)
+			{
+				auto lpCallbacks = messageCallbacks.Find(destination, id);
+
+				if (lpCallbacks == nullptr)
+				{
+
+					return false;
+				}
+
+				ClientOnMessageSentCallback callback;
+				lpCallbacks->Dequeue(callback);
+
+				if (lpCallbacks->GetSize() == 0)
+				{
+
+					messageCallbacks.Remove(destination, id);
+				}
+
+				callback();
+
+				return true;
+			}
+
+			// @throw AL::Exception
+			void ReceiveWeather(const Packet& packet)
+			{
+				if constexpr (IsDecodeSupported(ClientDecodeFlags::Weather))
+				{
+					Weather weather;
+
+					if (IsDecodeFlagSet(ClientDecodeFlags::Weather) && Weather::Decode(weather, packet))
+					{
+
+						this->OnWeatherReceived(packet, weather);
+					}
+				}
+			}
+
+			// @throw AL::Exception
+			void ReceivePosition(const Packet& packet)
+			{
+				if constexpr (IsDecodeSupported(ClientDecodeFlags::Position) || IsDecodeSupported(ClientDecodeFlags::Weather))
+				{
+					bool isPositionDecoded = IsDecodeFlagSet(ClientDecodeFlags::Position);
+					bool isWeatherDecoded  = IsDecodeFlagSet(ClientDecodeFlags::Weather);
+
+					if (!isPositionDecoded && !isWeatherDecoded)
+					{
+
+						return;
+					}
+
+					Position position;
+
+					if (!Position::Decode(position, packet))
+					{
+
+						return;
+					}
+
+					if (isPositionDecoded && !this->OnReadPosition(packet, position))
+					{
+
+						return;
+					}
+
+					if (isPositionDecoded)
+					{
+
+						this->OnPositionReceived(packet, position);
+					}
+
+					if constexpr (IsDecodeSupported(ClientDecodeFlags::Weather))
+					{
+						Weather weather;
+
+						// position with the weather station symbol
+						if (isWeatherDecoded && Weather::Decode(weather, position))
+						{
+
+							this->OnWeatherReceived(packet, weather);
+						}
+					}
+				}
+			}
+
+			// @throw AL::Exception
+			void ReceiveTelemetry(const Packet& packet)
+			{
+				if constexpr (IsDecodeSupported(ClientDecodeFlags::Telemetry))
+				{
+					Telemetry telemetry;
+
+					if (IsDecodeFlagSet(ClientDecodeFlags::Telemetry) && Telemetry::Decode(telemetry, packet))
+					{
+
+						this->OnTelemetryReceived(packet, telemetry);
+					}
+				}
+			}
+
+			// @throw AL::Exception
+			bool Authenticate()
+			{
+				auto line = [this]()
+				{
+					AL::StringBuilder sb;
+					sb << "user " << GetCallsign() << " pass " << passcode << " vers " APRS_SOFTWARE_NAME " " APRS_SOFTWARE_VERSION;
+
+					if (GetFilter().GetSize() != 0)
+					{
+						sb << " filter ";
+						sb << GetFilter();
+					}
+
+					return sb.ToString();
+				}();
+
+				try
+				{
+					if (!lpConnection->WriteLine(line))
+					{
+
+						return false;
+					}
+				}
+				catch (AL::Exception& exception)
+				{
+
+					throw AL::Exception(
+						AL::Move(exception),
+						"Error sending authentication"
+					);
+				}
+
+				{
+					AL::String                 line;
+					AL::Regex::MatchCollection matches;
+
+					// a non-blocking connection is polled until the logresp arrives or stallTimeout elapses
+					auto deadline = timer.GetElapsed() + stallTimeout;
+
+					for (int result; (result = lpConnection->ReadLine(line, false)) != 0; )
+					{
+						if (result == -1)
+						{
+							if ((stallTimeout.ToMicroseconds() != 0) && (timer.GetElapsed() >= deadline))
+							{
+
+								throw AL::Exception(
+									"Authentication timed out"
+								);
+							}
+
+							std::this_thread::yield();
+
+							continue;
+						}
+
+						if (line.StartsWith('#'))
+						{
+
+							this->OnServerCommentReceived(line);
+						}
+
+						// # logresp CALL verified, server NAME
+						if (AL::Regex::Match(matches, "^# logresp ([^ ]+) ([^ ,]+),? ?(server (.+))?$", line))
+						{
+							isVerified = matches[2].Compare("verified", true);
+							serverName = (matches.GetSize() > 4) ? AL::Move(matches[4]) : AL::String();
+
+							if (isVerified)
+							{
+
+								return true;
+							}
+
+							break;
+						}
+					}
+				}
+
+				return false;
+			}
+
+			// @throw AL::Exception
+			// @return 0 on connection closed
+			// @return -1 if would block
+			// @return -2 on decoding error
+			int ReadPacket(Packet& packet, AL::TimeSpan now)
+			{
+				try
+				{
+					switch (lpConnection->ReadLine(readBuffer, false))
+					{
+						case 0:
+							Disconnect();
+							return 0;
+
+						case -1:
+							return -1;
+					}
+				}
+				catch (AL::Exception& exception)
+				{
+
+					throw AL::Exception(
+						AL::Move(exception),
+						"Error receiving packet buffer"
+					);
+				}
+
+				lastReceiveTime = now;
+
+				if (!Packet::Decode(packet, readBuffer))
+				{
+					if (readBuffer.StartsWith('#'))
+					{
+						this->OnServerCommentReceived(readBuffer);
+
+						return -1;
+					}
+
+					return -2;
+				}
+
+				return 1;
+			}
+
+			// Moves queued packets into their priority queues and writes as many as the rate limit allows with a single write
+			// @throw AL::Exception
+			// @return false on connection closed
+			bool FlushSendQueue(AL::TimeSpan now)
+			{
+				sendQueue.DequeueAll([this](_QueuedPacket& packet)
+				{
+					sendPriorityQueues[static_cast<AL::size_t>(packet.Priority)].Enqueue(AL::Move(packet));
+
+					++sendPendingCount;
+				});
+
+				sendRateLimit.Update(now);
+
+				AL::size_t count = 0;
+
+				writeBuffer.Clear();
+				sendBatch.Clear();
+
+				for (auto& queue : sendPriorityQueues)
+				{
+					for (_QueuedPacket packet; (queue.GetSize() != 0) && sendRateLimit.TryConsume() && queue.Dequeue(packet); ++count)
+					{
+						if (packet.HasCallback)
+						{
+							if (packet.Ack.GetLength() == 0)
+							{
+
+								packet.Ack = AllocateMessageId(packet.Destination);
+							}
+
+							packet.Line.Append('{');
+							packet.Line.Append(packet.Ack);
+
+							if (packet.ReplyAck.GetLength() != 0)
+							{
+								packet.Line.Append('}');
+								packet.Line.Append(packet.ReplyAck);
+							}
+						}
+
+						AppendLine(writeBuffer, packet.Line);
+
+						if (packet.HasCallback)
+						{
+
+							sendBatch.PushBack(AL::Move(packet));
+						}
+					}
+				}
+
+				if (count == 0)
+				{
+
+					return true;
+				}
+
+				sendPendingCount -= count;
+
+				try
+				{
+					if (!lpConnection->Write(writeBuffer.GetCString(), writeBuffer.GetLength()))
+					{
+						sendBatch.Clear();
+						Disconnect();
+
+						return false;
+					}
+				}
+				catch (AL::Exception& exception)
+				{
+					sendBatch.Clear();
+
+					throw AL::Exception(
+						AL::Move(exception),
+						"Error sending queued packets [Count: %lu]",
+						static_cast<unsigned long>(count)
+					);
+				}
+
+				// callbacks of packets lost with the connection are dropped instead of never firing
+				for (auto& packet : sendBatch)
+				{
+
+					messageCallbacks.Insert(packet.Destination, packet.Ack).Enqueue(AL::Move(packet.Callback));
+				}
+
+				sendBatch.Clear();
+
+				return true;
+			}
+
+			// Appends line to buffer as it would be written by Connection::WriteLine
+			static void AppendLine(AL::String& buffer, const AL::String& line)
+			{
+				buffer.Append(line.GetCString(), (line.GetLength() > 510) ? 510 : line.GetLength());
+				buffer.Append("\r\n", 2);
+			}
+
+			// @throw AL::Exception
+			// @return false on connection closed
+			bool WritePacket(const Packet& packet)
+			{
+				writeBuffer = packet.Encode();
+
+				try
+				{
+					if (!lpConnection->WriteLine(writeBuffer))
+					{
+						Disconnect();
+
+						return false;
+					}
+				}
+				catch (AL::Exception& exception)
+				{
+
+					throw AL::Exception(
+						AL::Move(exception),
+						"Error sending Packet [Buffer: %s]",
+						writeBuffer.GetCString()
+					);
+				}
+
+				return true;
+			}
+		};
+
+		typedef BasicClient<ClientPolicy>          Client;
+
+		typedef AL::Collections::Array<AL::String> GatewayCommandFilter;
+
+		// @throw AL::Exception
+		// @return false if not handled
+		typedef AL::Function<bool(const AL::String& sender, const AL::String& prefix, const AL::String& args)> GatewayCommandHandler;
+
+		class Gateway
+			: public Client
+		{
+			struct _CommandContext
+			{
+				bool                  IsFilterInverted = false;
+
+				AL::String            Prefix;
+				GatewayCommandFilter  Filter;
+				GatewayCommandHandler Handler;
+			};
+
+			AL::Collections::LinkedList<_CommandContext> commands;
+
+		public:
+			using Client::Client;
+
+			void RegisterCommand(const AL::String& prefix, GatewayCommandHandler&& handler)
+			{
+				RegisterCommand(prefix, AL::Move(handler), GatewayCommandFilter());
+			}
+			void RegisterCommand(const AL::String& prefix, GatewayCommandHandler&& handler, GatewayCommandFilter&& filter, bool invert_filter = false)
+			{
+				for (auto& command : commands)
+				{
+					if (command.Prefix.Compare(prefix, AL::True))
+					{
+						command.IsFilterInverted = invert_filter;
+						command.Filter  = AL::Move(filter);
+						command.Handler = AL::Move(handler);
+
+						return;
+					}
+				}
+
+				commands.PushBack(
+					{
+						.IsFilterInverted = invert_filter,
+						.Prefix           = prefix,
+						.Filter           = AL::Move(filter),
+						.Handler          = AL::Move(handler)
+					}
+				);
+			}
+
+			// @throw AL::Exception
+			// @return 0 if not registered
+			// @return -1 if not handled
+			// @return -2 if rejected by filter
+			int ExecuteCommand(const AL::String& sender, const AL::String& prefix, const AL::String& args)
+			{
+				for (auto& command : commands)
+				{
+					if (command.Prefix.Compare(prefix, AL::True))
+					{
+						bool is_filtered = true;
+
+						for (auto& filter : command.Filter)
+						{
+							if (filter.Compare(sender, AL::True))
+							{
+								if (command.IsFilterInverted)
+								{
+									is_filtered = false;
+
+									break;
+								}
+
+								return -2;
+							}
+						}
+
+						if (!is_filtered)
+						{
+
+							return -2;
+						}
+
+						if (!command.Handler(sender, prefix, args))
+						{
+
+							return -1;
+						}
+
+						return 1;
+					}
+				}
+
+				return 0;
+			}
+
+		protected:
+			// @throw AL::Exception
+			// @return false to stop processing
+			// virtual bool OnReadPacket(const Packet& packet) override
+			// {
+			// 	if (!Client::OnReadPacket(packet))
+			// 		return false;
+
+			// 	return true;
+			// }
+
+			// @throw AL::Exception
+			// @return false to stop processing
+			virtual bool OnReadMessage(const Packet& packet, const Message& message) override
+			{
+				if (!Client::OnReadMessage(packet, message))
+					return false;
+
+				AL::Regex::MatchCollection matches;
+
+				if (AL::Regex::Match(matches, "^([^ ]+) ?(.+)?$", message.Content))
+				{
+					switch (ExecuteCommand(packet.Sender, matches[1], (matches.GetSize() == 3) ? matches[2] : ""))
+					{
+						case 0:  return true;
+						case -1: return true;
+						case -2: return false;
+						default: return false;
+					}
+				}
+
+				return true;
+			}
+
+			// @throw AL::Exception
+			// @return false to stop processing
+			// virtual bool OnReadPosition(const Packet& packet, const Position& position) override
+			// {
+			// 	if (!Client::OnReadPosition(packet, position))
+			// 		return false;
+
+			// 	return true;
+			// }
+		};
+
+		// Subset of the APRS-IS server-side filter syntax:
+		//	p/aa/bb  - sender starts with any prefix
+		//	b/call/* - sender matches any call (trailing * wildcard)
+		//	t/poimstw - data type (position, object, item, message, status, telemetry, weather)
+		// Packets matching any term pass. An empty filter passes everything.
+		class ServerFilter
+		{
+			AL::Collections::ArrayList<AL::String> prefixes;
+			AL::Collections::ArrayList<AL::String> budlist;
+			AL::uint8                              types = 0;
+
+		public:
+			bool IsEmpty() const
+			{
+				return (prefixes.GetSize() == 0) && (budlist.GetSize() == 0) && (types == 0);
+			}
+
+			bool Match(const Packet& packet) const
+			{
+				if (IsEmpty())
+				{
+
+					return true;
+				}
+
+				if ((types & GetTypeFlag(packet.GetDataType())) != 0)
+				{
+
+					return true;
+				}
+
+				for (auto& prefix : prefixes)
+				{
+					if ((packet.Sender.GetLength() >= prefix.GetLength()) && (::memcmp(packet.Sender.GetCString(), prefix.GetCString(), prefix.GetLength()) == 0))
+					{
+
+						return true;
+					}
+				}
+
+				for (auto& call : budlist)
+				{
+					auto length = call.GetLength();
+
+					if ((length != 0) && (call.GetCString()[length - 1] == '*'))
+					{
+						if ((packet.Sender.GetLength() >= (length - 1)) && (::memcmp(packet.Sender.GetCString(), call.GetCString(), length - 1) == 0))
+						{
+
+							return true;
+						}
+					}
+					else if (packet.Sender.Compare(call))
+					{
+
+						return true;
 					}
+				}
 
-					AL::size_t numberOfBytesSent;
+				return false;
+			}
 
-					static constexpr char EOL[] = "\r\n";
+			// Note: unsupported terms are ignored
+			static ServerFilter Parse(const AL::String& value)
+			{
+				ServerFilter filter;
 
-					try
+				auto lpValue = value.GetCString();
+				auto length  = value.GetLength();
+
+				for (AL::size_t offset = 0; offset < length; )
+				{
+					auto end = offset + Tokenizer::Find(&lpValue[offset], length - offset, ' ');
+
+					if (((end - offset) > 2) && (lpValue[offset + 1] == '/'))
 					{
-						if (!AL::Network::SocketExtensions::SendAll(socket, value.GetCString(), valueLength, numberOfBytesSent) ||
-							!AL::Network::SocketExtensions::SendAll(socket, EOL, sizeof(EOL) - 1, numberOfBytesSent))
+						auto type = lpValue[offset];
+
+						for (AL::size_t i = offset + 2; i < end; )
 						{
-							Close();
+							auto next = i + Tokenizer::Find(&lpValue[i], end - i, '/');
 
-							return false;
+							if (next != i)
+							{
+								switch (type)
+								{
+									case 'p':
+										filter.prefixes.PushBack(AL::String(&lpValue[i], next - i));
+										break;
+
+									case 'b':
+										filter.budlist.PushBack(AL::String(&lpValue[i], next - i));
+										break;
+
+									case 't':
+										for (auto j = i; j < next; ++j)
+										{
+
+											filter.types |= GetTypeFlag(lpValue[j]);
+										}
+										break;
+								}
+							}
+
+							i = next + 1;
 						}
 					}
-					catch (AL::Exception&)
-					{
-						Close();
 
-						throw;
-					}
+					offset = end + 1;
+				}
 
-					return true;
+				return filter;
+			}
+
+		private:
+			static AL::uint8 GetTypeFlag(DataTypes type)
+			{
+				switch (type)
+				{
+					case DataTypes::Item:      return 0x01;
+					case DataTypes::Object:    return 0x02;
+					case DataTypes::Status:    return 0x04;
+					case DataTypes::Message:   return 0x08;
+					case DataTypes::Weather:   return 0x10;
+					case DataTypes::Position:  return 0x20;
+					case DataTypes::Telemetry: return 0x40;
+					case DataTypes::Unknown:   break;
+				}
+
+				return 0;
+			}
+
+			static AL::uint8 GetTypeFlag(AL::String::Char type)
+			{
+				switch (type)
+				{
+					case 'i': return GetTypeFlag(DataTypes::Item);
+					case 'o': return GetTypeFlag(DataTypes::Object);
+					case 's': return GetTypeFlag(DataTypes::Status);
+					case 'm': return GetTypeFlag(DataTypes::Message);
+					case 'w': return GetTypeFlag(DataTypes::Weather);
+					case 'p': return GetTypeFlag(DataTypes::Position);
+					case 't': return GetTypeFlag(DataTypes::Telemetry);
 				}
+
+				return 0;
+			}
+		};
+
+		typedef AL::EventHandler<void(const AL::String& callsign, bool verified)> ServerOnSessionConnectEventHandler;
+		typedef AL::EventHandler<void(const AL::String& callsign)>                ServerOnSessionDisconnectEventHandler;
+
+		// Accepts downstream logins and fans out lines to every session whose filter matches
+		// Note: sessions are receive-only, lines sent by downstream clients are discarded
+		class Server
+		{
+			// One encoded line shared by every session queue it was pushed to
+			struct _SharedLine
+			{
+				AL::size_t ReferenceCount;
+				AL::String Value;
 			};
 
-			typedef AL::Collections::Queue<ClientOnMessageSentCallback>               _MessageAckCallbackQueue;
-			typedef AL::Collections::Dictionary<AL::String, _MessageAckCallbackQueue> _MessageAckCallbacks;
+			struct _Session
+			{
+				AL::Network::TcpSocket*                  lpSocket;
+
+				bool                                     IsAuthenticated = false;
+				bool                                     IsVerified      = false;
+				// sessions not authenticated by then are closed
+				AL::TimeSpan                             LoginDeadline;
+
+				AL::String                               Callsign;
+				ServerFilter                             Filter;
+				AL::String                               LineBuffer;
 
-			bool                 isBlocking  = false;
-			bool                 isConnected = false;
+				AL::Collections::ArrayList<_SharedLine*> Queue;
+				AL::size_t                               QueueHead   = 0;
+				AL::size_t                               QueueOffset = 0;
+				AL::size_t                               QueueSize   = 0;
+			};
+
+			AL::String                            name;
+			AL::size_t                            maxQueueSize;
+			AL::OS::Timer                         timer;
+			AL::TimeSpan                          loginTimeout = AL::TimeSpan::FromSeconds(30);
 
-			AL::String           filter;
-			AL::String           callsign;
-			AL::uint16           passcode;
-			AL::String           packetBuffer;
-			Connection*          lpConnection;
-			_MessageAckCallbacks messageCallbacks;
+			AL::Network::TcpSocket*               lpListener      = nullptr;
+			AL::Network::TcpSocket*               lpPendingSocket = nullptr;
+			AL::Network::AddressFamilies          addressFamily;
+			AL::Collections::ArrayList<_Session*> sessions;
 
-			Client(Client&&) = delete;
-			Client(const Client&) = delete;
+			Server(Server&&) = delete;
+			Server(const Server&) = delete;
 
 		public:
-			// @throw AL::Exception
-			AL::Event<ClientOnConnectEventHandler>         OnConnect;
-			AL::Event<ClientOnDisconnectEventHandler>      OnDisconnect;
+			// bytes read from a session per Update so one flooding client can not stall the others
+			static constexpr AL::size_t SESSION_READ_LIMIT = 4096;
 
-			// @throw AL::Exception
-			AL::Event<ClientOnReceivePacketEventHandler>   OnReceivePacket;
-			// @throw AL::Exception
-			AL::Event<ClientOnReceiveMessageEventHandler>  OnReceiveMessage;
-			// @throw AL::Exception
-			AL::Event<ClientOnReceivePositionEventHandler> OnReceivePosition;
+			AL::Event<ServerOnSessionConnectEventHandler>    OnSessionConnect;
+			AL::Event<ServerOnSessionDisconnectEventHandler> OnSessionDisconnect;
 
-			Client(AL::String&& callsign, AL::uint16 passcode, AL::String&& filter)
-				: filter(
-					AL::Move(filter)
+			// @param maxQueueSize sessions with more than this many bytes pending are dropped
+			explicit Server(AL::String&& name, AL::size_t maxQueueSize = 1024 * 1024)
+				: name(
+					AL::Move(name)
 				),
-				callsign(
-					AL::Move(callsign)
-				),
-				passcode(
-					passcode
+				maxQueueSize(
+					maxQueueSize
 				)
 			{
 			}
 
-			virtual ~Client()
+			virtual ~Server()
 			{
-				if (IsConnected())
+				if (IsListening())
 				{
 
-					Disconnect();
+					Close();
 				}
 			}
 
-			bool IsBlocking() const
+			bool IsListening() const
 			{
-				return isBlocking;
+				return lpListener != nullptr;
 			}
 
-			bool IsConnected() const
+			auto& GetName() const
 			{
-				return isConnected;
+				return name;
 			}
 
-			auto& GetFilter() const
+			auto GetSessionCount() const
 			{
-				return filter;
+				return sessions.GetSize();
 			}
 
-			auto& GetCallsign() const
+			auto GetLoginTimeout() const
 			{
-				return callsign;
+				return loginTimeout;
 			}
 
-			// @throw AL::Exception
-			void SetBlocking(bool value)
+			// Sessions that have not sent a login line within value of connecting are closed
+			// Note: applies to sessions accepted after the change
+			void SetLoginTimeout(AL::TimeSpan value)
 			{
-				isBlocking = value;
-
-				if (IsConnected())
-				{
-					lpConnection->SetBlocking(
-						value
-					);
-				}
+				loginTimeout = value;
 			}
 
 			// @throw AL::Exception
-			void Connect(const AL::Network::IPEndPoint& remoteEP)
+			void Listen(const AL::Network::IPEndPoint& localEP, AL::size_t backlog = 16)
 			{
 				AL_ASSERT(
-					!IsConnected(),
-					"Client already connected"
+					!IsListening(),
+					"Server already listening"
 				);
 
-				lpConnection = new Connection(
-					remoteEP
+				auto lpSocket = new AL::Network::TcpSocket(
+					localEP.Host.GetFamily()
 				);
 
 				try
 				{
-					lpConnection->SetBlocking(IsBlocking());
-
-					lpConnection->Open();
-
-					if (!Authenticate())
-					{
-
-						throw AL::Exception(
-							"Authentication failed"
-						);
-					}
+					lpSocket->Open();
+					lpSocket->SetBlocking(false);
+					lpSocket->Bind(localEP);
+					lpSocket->Listen(backlog);
 				}
-				catch (AL::Exception&)
+				catch (AL::Exception& exception)
 				{
-					delete lpConnection;
-
-					throw;
-				}
-
-				isConnected = true;
+					delete lpSocket;
 
-				try
-				{
-					OnConnect.Execute();
+					throw AL::Exception(
+						AL::Move(exception),
+						"Error listening on %s:%u",
+						localEP.Host.ToString().GetCString(),
+						localEP.Port
+					);
 				}
-				catch (AL::Exception&)
-				{
-					Disconnect();
 
-					throw;
-				}
+				lpListener    = lpSocket;
+				addressFamily = localEP.Host.GetFamily();
 			}
 
-			void Disconnect()
+			void Close()
 			{
-				if (IsConnected())
+				if (IsListening())
 				{
-					messageCallbacks.Clear();
+					while (sessions.GetSize() != 0)
+					{
 
-					lpConnection->Close();
-					delete lpConnection;
+						CloseSession(sessions.GetSize() - 1);
+					}
 
-					isConnected = false;
+					delete lpPendingSocket;
+					lpPendingSocket = nullptr;
 
-					OnDisconnect.Execute();
+					lpListener->Close();
+					delete lpListener;
+					lpListener = nullptr;
 				}
 			}
 
+			// Accepts pending connections, reads logins and flushes queued lines
 			// @throw AL::Exception
-			// @return false on connection closed
-			bool Update()
+			void Update()
 			{
 				AL_ASSERT(
-					IsConnected(),
-					"Client not connected"
+					IsListening(),
+					"Server not listening"
 				);
 
-				Packet packet;
+				auto now = timer.GetElapsed();
 
-				switch (ReadPacket(packet))
-				{
-					case 0:  return false;
-					case -1: return true;
-					case -2: return true;
-				}
+				Accept(now);
 
-				if (OnReadPacket(packet))
+				for (AL::size_t i = 0; i < sessions.GetSize(); )
 				{
-					OnReceivePacket.Execute(packet);
+					auto lpSession = sessions[i];
 
-					if (packet.IsMessage())
+					if (!ReadSession(*lpSession) || !FlushSession(*lpSession) || (lpSession->QueueSize > maxQueueSize) ||
+						(!lpSession->IsAuthenticated && (now >= lpSession->LoginDeadline)))
 					{
-						Message message;
-
-						if (Message::Decode(message, packet) && OnReadMessage(packet, message))
-						{
-							AL::Regex::MatchCollection matches;
-
-							if (AL::Regex::Match(matches, "^ack(.+)$", message.Content))
-							{
-								auto it = messageCallbacks.Find(matches[1]);
-
-								if (it != messageCallbacks.end())
-								{
-									ClientOnMessageSentCallback callback;
-									it->Value.Dequeue(callback);
+						CloseSession(i);
 
-									if (it->Value.GetSize() == 0)
-										messageCallbacks.Erase(it);
+						continue;
+					}
 
-									callback();
+					++i;
+				}
+			}
 
-									return true;
-								}
-							}
+			// Encodes packet once and queues it for every authenticated session whose filter matches
+			// @return number of sessions the line was queued for
+			AL::size_t Broadcast(const Packet& packet)
+			{
+				_SharedLine* lpLine = nullptr;
+				AL::size_t   count  = 0;
 
-							OnReceiveMessage.Execute(packet, message);
+				for (auto lpSession : sessions)
+				{
+					if (!lpSession->IsAuthenticated || (!lpSession->Filter.Match(packet) && !IsAddressedTo(packet, lpSession->Callsign)))
+					{
 
-							return true;
-						}
+						continue;
 					}
-					else if (packet.IsPosition())
-					{
-						Position position;
 
-						if (Position::Decode(position, packet) && OnReadPosition(packet, position))
+					if (lpLine == nullptr)
+					{
+						lpLine = new _SharedLine
 						{
-							OnReceivePosition.Execute(packet, position);
-
-							return true;
-						}
+							.ReferenceCount = 0,
+							.Value          = Encode(packet)
+						};
 					}
+
+					Enqueue(*lpSession, lpLine);
+
+					++count;
 				}
 
-				return true;
+				return count;
 			}
 
-			// Note: This bypasses automatic ack handling
-			// @throw AL::Exception
-			// @return false on connection closed
-			bool SendPacket(const Packet& value)
+			// Queues a server comment (e.g. "# keepalive") for every authenticated session
+			// @return number of sessions the line was queued for
+			AL::size_t BroadcastComment(const AL::String& comment)
 			{
-				AL_ASSERT(
-					IsConnected(),
-					"Client not connected"
-				);
+				_SharedLine* lpLine = nullptr;
+				AL::size_t   count  = 0;
 
-				return WritePacket(value);
-			}
+				for (auto lpSession : sessions)
+				{
+					if (!lpSession->IsAuthenticated)
+					{
 
-			// @throw AL::Exception
-			// @return false on connection closed
-			bool SendMessage(const Message& value, const AL::String& tocall, const AL::String& path)
-			{
-				AL_ASSERT(
-					IsConnected(),
-					"Client not connected"
-				);
+						continue;
+					}
 
-				return WritePacket(value.Encode(tocall, GetCallsign(), path));
-			}
-			// @throw AL::Exception
-			// @return false on connection closed
-			bool SendMessage(const Message& value, const AL::String& tocall, const AL::String& path, ClientOnMessageSentCallback&& callback)
-			{
-				AL_ASSERT(
-					IsConnected(),
-					"Client not connected"
-				);
+					if (lpLine == nullptr)
+					{
+						lpLine = new _SharedLine
+						{
+							.ReferenceCount = 0,
+							.Value          = AL::String::Format("# %s\r\n", comment.GetCString())
+						};
+					}
 
-				if (!WritePacket(value.Encode(tocall, GetCallsign(), path)))
-				{
+					Enqueue(*lpSession, lpLine);
 
-					return false;
+					++count;
 				}
 
-				if (value.Ack.GetLength() == 0)
-					callback();
-				else
-					messageCallbacks[value.Ack].Enqueue(AL::Move(callback));
-
-				return true;
+				return count;
 			}
 
-			// @throw AL::Exception
-			// @return false on connection closed
-			bool SendPosition(const Position& value, const AL::String& tocall, const AL::String& path)
+			// APRS-IS passcode for callsign (SSID ignored)
+			static AL::uint16 ComputePasscode(const AL::String& callsign)
 			{
-				AL_ASSERT(
-					IsConnected(),
-					"Client not connected"
-				);
+				AL::uint16 hash     = 0x73E2;
+				auto       lpValue  = callsign.GetCString();
+				auto       length   = Tokenizer::Find(lpValue, callsign.GetLength(), '-');
 
-				return WritePacket(value.Encode(tocall, GetCallsign(), path));
-			}
+				auto toUpper = [](AL::String::Char c)
+				{
+					return static_cast<AL::uint8>(((c >= 'a') && (c <= 'z')) ? (c - 'a' + 'A') : c);
+				};
 
-		protected:
-			// @throw AL::Exception
-			// @return false to stop processing
-			virtual bool OnReadPacket(const Packet& packet)
-			{
-				return true;
-			}
+				for (AL::size_t i = 0; i < length; i += 2)
+				{
+					hash ^= static_cast<AL::uint16>(toUpper(lpValue[i]) << 8);
 
-			// @throw AL::Exception
-			// @return false to stop processing
-			virtual bool OnReadMessage(const Packet& packet, const Message& message)
-			{
-				return true;
-			}
+					if ((i + 1) < length)
+					{
 
-			// @throw AL::Exception
-			// @return false to stop processing
-			virtual bool OnReadPosition(const Packet& packet, const Position& position)
-			{
-				return true;
+						hash ^= toUpper(lpValue[i + 1]);
+					}
+				}
+
+				return hash & 0x7FFF;
 			}
 
 		private:
 			// @throw AL::Exception
-			bool Authenticate()
+			void Accept(AL::TimeSpan now)
 			{
-				auto line = [this]()
+				for (;;)
 				{
-					AL::StringBuilder sb;
-					sb << "user " << GetCallsign() << " pass " << passcode << " vers " APRS_SOFTWARE_NAME " " APRS_SOFTWARE_VERSION;
+					if (lpPendingSocket == nullptr)
+					{
+
+						lpPendingSocket = new AL::Network::TcpSocket(addressFamily);
+					}
+
+					if (!lpListener->Accept(*lpPendingSocket))
+					{
+
+						break;
+					}
+
+					auto lpSession           = new _Session();
+					lpSession->lpSocket      = lpPendingSocket;
+					lpSession->LoginDeadline = now + loginTimeout;
+					lpPendingSocket          = nullptr;
+
+					try
+					{
+						lpSession->lpSocket->SetBlocking(false);
+					}
+					catch (AL::Exception&)
+					{
+						lpSession->lpSocket->Close();
+						delete lpSession->lpSocket;
+						delete lpSession;
+
+						continue;
+					}
+
+					sessions.PushBack(lpSession);
 
-					if (GetFilter().GetSize() != 0)
+					Enqueue(*lpSession, new _SharedLine
 					{
-						sb << " filter ";
-						sb << GetFilter();
-					}
+						.ReferenceCount = 0,
+						.Value          = "# " APRS_SOFTWARE_NAME " " APRS_SOFTWARE_VERSION "\r\n"
+					});
+				}
+			}
 
-					return sb.ToString();
-				}();
+			// Reads at most SESSION_READ_LIMIT bytes, the rest is left for the next Update
+			// @return false if the session should be closed
+			bool ReadSession(_Session& session)
+			{
+				AL::String::Char buffer[512];
+				AL::size_t       numberOfBytesReceived;
 
-				try
+				for (AL::size_t total = 0; total < SESSION_READ_LIMIT; total += numberOfBytesReceived)
 				{
-					if (!lpConnection->WriteLine(line))
+					try
+					{
+						if (!session.lpSocket->Receive(buffer, sizeof(buffer), numberOfBytesReceived))
+						{
+
+							return false;
+						}
+					}
+					catch (AL::Exception&)
 					{
 
 						return false;
 					}
-				}
-				catch (AL::Exception& exception)
-				{
 
-					throw AL::Exception(
-						AL::Move(exception),
-						"Error sending authentication"
-					);
-				}
+					if (numberOfBytesReceived == 0)
+					{
 
-				{
-					AL::String                 line;
-					AL::Regex::MatchCollection matches;
+						return true;
+					}
 
-					while (lpConnection->ReadLine(line, true) > 0)
+					for (AL::size_t offset = 0; offset < numberOfBytesReceived; )
 					{
-						if (AL::Regex::Match(matches, "^# logresp ([^ ]+) (.+)$", line))
+						auto size = Tokenizer::Find(&buffer[offset], numberOfBytesReceived - offset, '\n');
+
+						if (size == (numberOfBytesReceived - offset))
 						{
-							if (matches[2].StartsWith("verified", true))
+							session.LineBuffer.Append(&buffer[offset], size);
+
+							// a login line is short, anything longer is not a client
+							if (session.LineBuffer.GetLength() > 512)
 							{
 
-								return true;
+								return false;
 							}
 
 							break;
 						}
+
+						session.LineBuffer.Append(&buffer[offset], size);
+						offset += size + 1;
+
+						if (!session.IsAuthenticated && !Login(session, session.LineBuffer))
+						{
+
+							return false;
+						}
+
+						session.LineBuffer.Clear();
 					}
 				}
 
-				return false;
+				return true;
 			}
 
-			// @throw AL::Exception
-			// @return 0 on connection closed
-			// @return -1 if would block
-			// @return -2 on decoding error
-			int ReadPacket(Packet& packet)
+			// user CALL pass NNNN vers NAME VERSION [filter ...]
+			// @return false if the line is neither a login, a comment nor empty
+			bool Login(_Session& session, const AL::String& line)
 			{
-				try
+				auto lpLine = line.GetCString();
+				auto length = line.GetLength();
+
+				if ((length != 0) && (lpLine[length - 1] == '\r'))
 				{
-					switch (lpConnection->ReadLine(packetBuffer, false))
-					{
-						case 0:
-							Disconnect();
-							return 0;
 
-						case -1:
-							return -1;
-					}
+					--length;
 				}
-				catch (AL::Exception& exception)
+
+				// empty lines and comments are ignored
+				if ((length == 0) || (lpLine[0] == '#'))
 				{
 
-					throw AL::Exception(
-						AL::Move(exception),
-						"Error receiving packet buffer"
-					);
+					return true;
 				}
 
-				if (!Packet::Decode(packet, packetBuffer))
+				AL::size_t       offset = 0;
+				AL::String::Char token[16];
+
+				auto next = [&](AL::size_t& tokenLength)
 				{
-					if (packetBuffer.StartsWith('#'))
+					while ((offset < length) && (lpLine[offset] == ' '))
 					{
 
-						return -1;
+						++offset;
 					}
 
-					return -2;
-				}
+					auto begin  = offset;
+					offset     += Tokenizer::Find(&lpLine[offset], length - offset, ' ');
+					tokenLength = offset - begin;
 
-				return 1;
-			}
+					return &lpLine[begin];
+				};
 
-			// @throw AL::Exception
-			// @return false on connection closed
-			bool WritePacket(const Packet& packet)
-			{
-				packetBuffer = packet.Encode();
+				auto isToken = [](const AL::String::Char* lpToken, AL::size_t tokenLength, const char* value)
+				{
+					return (tokenLength == ::strlen(value)) && (::memcmp(lpToken, value, tokenLength) == 0);
+				};
 
-				try
+				AL::size_t tokenLength;
+				auto       lpToken = next(tokenLength);
+
+				if (!isToken(lpToken, tokenLength, "user"))
 				{
-					if (!lpConnection->WriteLine(packetBuffer))
-					{
-						Disconnect();
 
-						return false;
-					}
+					return false;
 				}
-				catch (AL::Exception& exception)
+
+				lpToken = next(tokenLength);
+
+				if ((tokenLength == 0) || (tokenLength > 9 + 1 + 2))
 				{
 
-					throw AL::Exception(
-						AL::Move(exception),
-						"Error sending Packet [Buffer: %s]",
-						packetBuffer.GetCString()
-					);
+					return false;
 				}
 
-				return true;
-			}
-		};
+				session.Callsign = AL::String(lpToken, tokenLength);
 
-		typedef AL::Collections::Array<AL::String> GatewayCommandFilter;
+				while (offset < length)
+				{
+					lpToken = next(tokenLength);
 
-		// @throw AL::Exception
-		// @return false if not handled
-		typedef AL::Function<bool(const AL::String& sender, const AL::String& prefix, const AL::String& args)> GatewayCommandHandler;
+					if (isToken(lpToken, tokenLength, "pass"))
+					{
+						lpToken = next(tokenLength);
 
-		class Gateway
-			: public Client
-		{
-			struct _CommandContext
-			{
-				bool                  IsFilterInverted = false;
+						if ((tokenLength != 0) && (tokenLength < sizeof(token)))
+						{
+							::memcpy(token, lpToken, tokenLength);
+							token[tokenLength] = '\0';
 
-				AL::String            Prefix;
-				GatewayCommandFilter  Filter;
-				GatewayCommandHandler Handler;
-			};
+							AL::uint32 passcode;
 
-			AL::Collections::LinkedList<_CommandContext> commands;
+							session.IsVerified = Position::DecodeDigits(token, tokenLength, passcode) && (passcode == ComputePasscode(session.Callsign));
+						}
+					}
+					else if (isToken(lpToken, tokenLength, "filter"))
+					{
+						while ((offset < length) && (lpLine[offset] == ' '))
+						{
 
-		public:
-			using Client::Client;
+							++offset;
+						}
 
-			void RegisterCommand(const AL::String& prefix, GatewayCommandHandler&& handler)
-			{
-				RegisterCommand(prefix, AL::Move(handler), GatewayCommandFilter());
+						session.Filter = ServerFilter::Parse(AL::String(&lpLine[offset], length - offset));
+
+						break;
+					}
+				}
+
+				session.IsAuthenticated = true;
+
+				Enqueue(session, new _SharedLine
+				{
+					.ReferenceCount = 0,
+					.Value          = AL::String::Format(
+						"# logresp %s %s, server %s\r\n",
+						session.Callsign.GetCString(),
+						session.IsVerified ? "verified" : "unverified",
+						GetName().GetCString()
+					)
+				});
+
+				OnSessionConnect.Execute(session.Callsign, session.IsVerified);
+
+				return true;
 			}
-			void RegisterCommand(const AL::String& prefix, GatewayCommandHandler&& handler, GatewayCommandFilter&& filter, bool invert_filter = false)
+
+			// @return false if the session should be closed
+			bool FlushSession(_Session& session)
 			{
-				for (auto& command : commands)
+				while (session.QueueHead < session.Queue.GetSize())
 				{
-					if (command.Prefix.Compare(prefix, AL::True))
+					auto  lpLine = session.Queue[session.QueueHead];
+					auto& value  = lpLine->Value;
+
+					AL::size_t numberOfBytesSent;
+
+					try
 					{
-						command.IsFilterInverted = invert_filter;
-						command.Filter  = AL::Move(filter);
-						command.Handler = AL::Move(handler);
+						if (!session.lpSocket->Send(&value.GetCString()[session.QueueOffset], value.GetLength() - session.QueueOffset, numberOfBytesSent))
+						{
 
-						return;
+							return false;
+						}
 					}
-				}
+					catch (AL::Exception&)
+					{
 
-				commands.PushBack(
+						return false;
+					}
+
+					session.QueueOffset += numberOfBytesSent;
+
+					if (session.QueueOffset < value.GetLength())
 					{
-						.IsFilterInverted = invert_filter,
-						.Prefix           = prefix,
-						.Filter           = AL::Move(filter),
-						.Handler          = AL::Move(handler)
+						// would block
+						break;
 					}
-				);
+
+					session.QueueSize  -= value.GetLength();
+					session.QueueOffset = 0;
+					++session.QueueHead;
+
+					Release(lpLine);
+				}
+
+				if (session.QueueHead == session.Queue.GetSize())
+				{
+					session.Queue.Clear();
+					session.QueueHead = 0;
+				}
+
+				return true;
 			}
 
-			// @throw AL::Exception
-			// @return 0 if not registered
-			// @return -1 if not handled
-			// @return -2 if rejected by filter
-			int ExecuteCommand(const AL::String& sender, const AL::String& prefix, const AL::String& args)
+			void Enqueue(_Session& session, _SharedLine* lpLine)
 			{
-				for (auto& command : commands)
-				{
-					if (command.Prefix.Compare(prefix, AL::True))
-					{
-						bool is_filtered = true;
+				++lpLine->ReferenceCount;
 
-						for (auto& filter : command.Filter)
-						{
-							if (filter.Compare(sender, AL::True))
-							{
-								if (command.IsFilterInverted)
-								{
-									is_filtered = false;
+				session.Queue.PushBack(lpLine);
+				session.QueueSize += lpLine->Value.GetLength();
+			}
 
-									break;
-								}
+			void CloseSession(AL::size_t index)
+			{
+				auto lpSession = sessions[index];
 
-								return -2;
-							}
-						}
+				for (auto i = lpSession->QueueHead; i < lpSession->Queue.GetSize(); ++i)
+				{
 
-						if (!is_filtered)
-						{
+					Release(lpSession->Queue[i]);
+				}
 
-							return -2;
-						}
+				lpSession->lpSocket->Close();
+				delete lpSession->lpSocket;
 
-						if (!command.Handler(sender, prefix, args))
-						{
+				sessions.RemoveAt(index);
 
-							return -1;
-						}
+				if (lpSession->IsAuthenticated)
+				{
 
-						return 1;
-					}
+					OnSessionDisconnect.Execute(lpSession->Callsign);
 				}
 
-				return 0;
+				delete lpSession;
 			}
 
-		protected:
-			// @throw AL::Exception
-			// @return false to stop processing
-			// virtual bool OnReadPacket(const Packet& packet) override
-			// {
-			// 	if (!Client::OnReadPacket(packet))
-			// 		return false;
+			static void Release(_SharedLine* lpLine)
+			{
+				if (--lpLine->ReferenceCount == 0)
+				{
 
-			// 	return true;
-			// }
+					delete lpLine;
+				}
+			}
 
-			// @throw AL::Exception
-			// @return false to stop processing
-			virtual bool OnReadMessage(const Packet& packet, const Message& message) override
+			// Messages addressed to the session callsign bypass its filter
+			static bool IsAddressedTo(const Packet& packet, const AL::String& callsign)
 			{
-				if (!Client::OnReadMessage(packet, message))
+				auto lpContent = packet.Content.GetCString();
+				auto length    = callsign.GetLength();
+
+				if ((packet.Content.GetLength() < 11) || (lpContent[0] != ':') || (length > 9))
+				{
+
 					return false;
+				}
 
-				AL::Regex::MatchCollection matches;
+				if (::memcmp(&lpContent[1], callsign.GetCString(), length) != 0)
+				{
 
-				if (AL::Regex::Match(matches, "^([^ ]+) ?(.+)?$", message.Content))
+					return false;
+				}
+
+				for (auto i = 1 + length; i < 10; ++i)
 				{
-					switch (ExecuteCommand(packet.Sender, matches[1], (matches.GetSize() == 3) ? matches[2] : ""))
+					if (lpContent[i] != ' ')
 					{
-						case 0:  return true;
-						case -1: return true;
-						case -2: return false;
-						default: return false;
+
+						return false;
 					}
 				}
 
-				return true;
+				return lpContent[10] == ':';
 			}
 
-			// @throw AL::Exception
-			// @return false to stop processing
-			// virtual bool OnReadPosition(const Packet& packet, const Position& position) override
-			// {
-			// 	if (!Client::OnReadPosition(packet, position))
-			// 		return false;
+			// SENDER>TOCALL[,DIGIPATH],QFLAG,IGATE:CONTENT\r\n
+			static AL::String Encode(const Packet& packet)
+			{
+				AL::String line;
 
-			// 	return true;
-			// }
+				line.Append(packet.Sender);
+				line.Append('>');
+				line.Append(packet.ToCall);
+
+				if (packet.DigiPath.GetLength() != 0)
+				{
+					line.Append(',');
+					line.Append(packet.DigiPath);
+				}
+
+				line.Append(',');
+				line.Append(packet.QFlag);
+				line.Append(',');
+				line.Append(packet.IGate);
+				line.Append(':');
+				line.Append(packet.Content);
+				line.Append("\r\n", 2);
+
+				return line;
+			}
 		};
 	}
 }
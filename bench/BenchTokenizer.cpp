@@ -0,0 +1,187 @@
+#include "../APRS-IS.hpp"
+
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Measures the tokenizer and header decoder on a captured feed (one TNC2 line per row, e.g. a raw APRS-IS dump)
+//	g++ -std=c++20 -O2 -march=native -I<AbstractionLayer> BenchTokenizer.cpp -o BenchTokenizer
+//	./BenchTokenizer feed.txt [iterations]
+// -march=native selects AVX2 where available, x86-64 builds without it use SSE2
+
+template<typename F>
+static void Measure(const char* lpName, size_t bytes, size_t iterations, F&& function)
+{
+	size_t result = 0;
+	auto   start  = std::chrono::steady_clock::now();
+
+	for (size_t i = 0; i < iterations; ++i)
+	{
+
+		result += function();
+	}
+
+	auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// result is printed so the work can not be optimized away
+	::printf("%-24s %10.1f MB/s (%zu)\n", lpName, (static_cast<double>(bytes) * iterations) / (seconds * 1000000), result);
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		::fprintf(stderr, "Usage: %s <feed> [iterations]\n", argv[0]);
+
+		return 1;
+	}
+
+	auto lpFile = ::fopen(argv[1], "rb");
+
+	if (lpFile == nullptr)
+	{
+		::fprintf(stderr, "Error opening %s\n", argv[1]);
+
+		return 1;
+	}
+
+	std::vector<AL::String::Char> buffer;
+	AL::String::Char              chunk[65536];
+
+	for (size_t size; (size = ::fread(chunk, 1, sizeof(chunk), lpFile)) != 0; )
+	{
+
+		buffer.insert(buffer.end(), chunk, chunk + size);
+	}
+
+	::fclose(lpFile);
+
+	auto   size       = buffer.size();
+	size_t iterations = (argc > 2) ? static_cast<size_t>(::atoi(argv[2])) : 10;
+
+	// padded so Classify can read the last partial block
+	buffer.resize(size + APRS::Tokenizer::BLOCK_SIZE, 0);
+
+	Measure("Classify", size, iterations, [&]()
+	{
+		size_t count = 0;
+
+		for (size_t i = 0; i < size; i += APRS::Tokenizer::BLOCK_SIZE)
+		{
+			AL::uint64 lineFeeds, delimiters;
+			APRS::Tokenizer::Classify(&buffer[i], lineFeeds, delimiters);
+
+			count += static_cast<size_t>(std::popcount(lineFeeds | delimiters));
+		}
+
+		return count;
+	});
+
+	Measure("ClassifyScalar", size, iterations, [&]()
+	{
+		size_t count = 0;
+
+		for (size_t i = 0; i < size; i += APRS::Tokenizer::BLOCK_SIZE)
+		{
+			AL::uint64 lineFeeds, delimiters;
+			APRS::Tokenizer::ClassifyScalar(&buffer[i], lineFeeds, delimiters);
+
+			count += static_cast<size_t>(std::popcount(lineFeeds | delimiters));
+		}
+
+		return count;
+	});
+
+	std::vector<APRS::TokenizerLine> lines(4096);
+
+	Measure("Tokenize", size, iterations, [&]()
+	{
+		size_t count = 0;
+
+		for (size_t offset = 0; offset < size; )
+		{
+			AL::size_t consumed;
+			count += APRS::Tokenizer::Tokenize(&buffer[offset], size - offset, lines.data(), lines.size(), consumed);
+
+			if (consumed == 0)
+			{
+
+				break;
+			}
+
+			offset += consumed;
+		}
+
+		return count;
+	});
+
+	// the byte at a time framing Tokenize replaced
+	Measure("Byte loop", size, iterations, [&]()
+	{
+		size_t count = 0;
+
+		for (size_t i = 0; i < size; ++i)
+		{
+			if (buffer[i] == '\n')
+				++count;
+			else if (APRS::Tokenizer::IsDelimiter(buffer[i]))
+				++count;
+		}
+
+		return count;
+	});
+
+	std::vector<AL::String> strings;
+
+	for (size_t offset = 0; offset < size; )
+	{
+		AL::size_t consumed;
+		auto       count = APRS::Tokenizer::Tokenize(&buffer[offset], size - offset, lines.data(), lines.size(), consumed);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+
+			strings.push_back(AL::String(&buffer[offset + lines[i].Offset], lines[i].Length));
+		}
+
+		if (consumed == 0)
+		{
+
+			break;
+		}
+
+		offset += consumed;
+	}
+
+	APRS::Packet packet;
+
+	Measure("Packet::Decode", size, iterations, [&]()
+	{
+		size_t count = 0;
+
+		for (auto& string : strings)
+		{
+
+			count += APRS::Packet::Decode(packet, string) ? 1 : 0;
+		}
+
+		return count;
+	});
+
+	Measure("Packet::DecodeRegex", size, iterations, [&]()
+	{
+		size_t count = 0;
+
+		for (auto& string : strings)
+		{
+
+			count += APRS::Packet::DecodeRegex(packet, string) ? 1 : 0;
+		}
+
+		return count;
+	});
+
+	return 0;
+}
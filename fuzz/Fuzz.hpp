@@ -0,0 +1,31 @@
+#pragma once
+#include "../APRS-IS.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+// Shared by the libFuzzer targets in this directory, see README.md
+
+// Wraps untrusted bytes as the content of a packet with a fixed header
+// so content decoders are reached without the fuzzer having to discover a valid header
+inline APRS::Packet FuzzMakePacket(const uint8_t* lpData, size_t size)
+{
+	return APRS::Packet
+	{
+		.IGate    = "T2TEST",
+		.QFlag    = "qAR",
+		.ToCall   = "APRS",
+		.Sender   = "N0CALL",
+		.Content  = AL::String(reinterpret_cast<const AL::String::Char*>(lpData), size),
+		.DigiPath = "WIDE1-1"
+	};
+}
+
+[[noreturn]] inline void FuzzFail(const char* lpTarget, const char* lpMessage)
+{
+	::fprintf(stderr, "%s: %s\n", lpTarget, lpMessage);
+	::fflush(stderr);
+
+	::abort();
+}
@@ -0,0 +1,16 @@
+#include "Fuzz.hpp"
+
+// Input: one TNC2 line without the terminator
+// Aborts when a fast path decoder disagrees with its reference implementation
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* lpData, size_t size)
+{
+	AL::String mismatch;
+
+	if (!APRS::DecoderDifferential::Compare(reinterpret_cast<const AL::String::Char*>(lpData), size, mismatch))
+	{
+
+		FuzzFail("FuzzDifferential", mismatch.GetCString());
+	}
+
+	return 0;
+}
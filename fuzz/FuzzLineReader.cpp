@@ -0,0 +1,144 @@
+#include "Fuzz.hpp"
+
+#include <vector>
+#include <string>
+
+// Stands in for AL::Network::TcpSocket: delivers the stream in chunks whose sizes come
+// from the input and reports "would block" (0 bytes) between chunks
+class FuzzSource
+{
+	const uint8_t* lpData;
+	size_t         size;
+	size_t         offset = 0;
+	uint8_t        seed;
+	bool           isBlocked = false;
+
+public:
+	FuzzSource(const uint8_t* lpData, size_t size, uint8_t seed)
+		: lpData(
+			lpData
+		),
+		size(
+			size
+		),
+		seed(
+			seed
+		)
+	{
+	}
+
+	bool Receive(void* lpBuffer, AL::size_t bufferSize, AL::size_t& numberOfBytesReceived)
+	{
+		if (offset == size)
+		{
+
+			return false;
+		}
+
+		if ((isBlocked = !isBlocked) && (seed & 1))
+		{
+			numberOfBytesReceived = 0;
+
+			return true;
+		}
+
+		// 1..256 bytes, varied per chunk so lines and "\r\n" straddle chunk boundaries
+		seed                  = static_cast<uint8_t>((seed * 37) + 11);
+		numberOfBytesReceived = static_cast<size_t>(seed) + 1;
+
+		if (numberOfBytesReceived > bufferSize)
+			numberOfBytesReceived = bufferSize;
+
+		if (numberOfBytesReceived > (size - offset))
+			numberOfBytesReceived = size - offset;
+
+		::memcpy(lpBuffer, &lpData[offset], numberOfBytesReceived);
+		offset += numberOfBytesReceived;
+
+		return true;
+	}
+};
+
+// Input: 1 byte maximum line length, 1 byte chunk seed, then the stream
+// Compares LineReader against a byte-at-a-time split of the same stream
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* lpData, size_t size)
+{
+	if (size < 2)
+	{
+
+		return 0;
+	}
+
+	AL::size_t maxLineLength = lpData[0];
+	auto       lpStream      = &lpData[2];
+	auto       streamSize    = size - 2;
+
+	std::vector<std::string> lines;
+	AL::size_t               dropCount = 0;
+
+	size_t begin = 0;
+
+	for (size_t i = 0; i < streamSize; ++i)
+	{
+		if (lpStream[i] == '\n')
+		{
+			auto end = i;
+
+			if ((end > begin) && (lpStream[end - 1] == '\r'))
+			{
+
+				--end;
+			}
+
+			if ((end - begin) > maxLineLength)
+				++dropCount;
+			else
+				lines.emplace_back(reinterpret_cast<const char*>(&lpStream[begin]), end - begin);
+
+			begin = i + 1;
+		}
+	}
+
+	// an unterminated line is counted as dropped as soon as it can no longer fit (allowing for its '\r')
+	if ((streamSize - begin) > (maxLineLength + 1))
+	{
+
+		++dropCount;
+	}
+
+	FuzzSource                       source(lpStream, streamSize, lpData[1]);
+	APRS::IS::LineReader<FuzzSource> reader(source, maxLineLength);
+	AL::String                       line;
+	size_t                           count = 0;
+
+	for (int result; (result = reader.ReadLine(line, false)) != 0; )
+	{
+		if (result == -1)
+		{
+
+			continue;
+		}
+
+		if ((count == lines.size()) || (line.GetLength() != lines[count].size()) || (::memcmp(line.GetCString(), lines[count].data(), line.GetLength()) != 0))
+		{
+
+			FuzzFail("FuzzLineReader", "line mismatch");
+		}
+
+		++count;
+	}
+
+	if (count != lines.size())
+	{
+
+		FuzzFail("FuzzLineReader", "line count mismatch");
+	}
+
+	if (reader.GetDropCount() != dropCount)
+	{
+
+		FuzzFail("FuzzLineReader", "drop count mismatch");
+	}
+
+	return 0;
+}
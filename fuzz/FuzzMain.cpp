@@ -0,0 +1,37 @@
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+
+// Replays files through a target without libFuzzer, for compilers without -fsanitize=fuzzer
+// and for running the seed corpus offline, e.g. FuzzPacket corpus/packet/*
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* lpData, size_t size);
+
+int main(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		auto lpFile = ::fopen(argv[i], "rb");
+
+		if (lpFile == nullptr)
+		{
+			::fprintf(stderr, "Error opening %s\n", argv[i]);
+
+			return 1;
+		}
+
+		std::vector<uint8_t> buffer;
+		uint8_t              chunk[4096];
+
+		for (size_t size; (size = ::fread(chunk, 1, sizeof(chunk), lpFile)) != 0; )
+		{
+
+			buffer.insert(buffer.end(), chunk, chunk + size);
+		}
+
+		::fclose(lpFile);
+
+		LLVMFuzzerTestOneInput(buffer.data(), buffer.size());
+	}
+
+	return 0;
+}
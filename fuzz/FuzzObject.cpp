@@ -0,0 +1,12 @@
+#include "Fuzz.hpp"
+
+// Input: packet content, see FuzzMakePacket
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* lpData, size_t size)
+{
+	auto packet = FuzzMakePacket(lpData, size);
+
+	APRS::Object value;
+	APRS::Object::Decode(value, packet);
+
+	return 0;
+}
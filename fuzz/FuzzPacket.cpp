@@ -0,0 +1,26 @@
+#include "Fuzz.hpp"
+
+// Input: one TNC2 line without the terminator
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* lpData, size_t size)
+{
+	auto lpLine = reinterpret_cast<const AL::String::Char*>(lpData);
+
+	APRS::TokenizerLine line;
+	APRS::Tokenizer::TokenizeLine(lpLine, size, line);
+
+	APRS::PacketSpan span;
+
+	if (APRS::Packet::Decode(span, lpLine, line))
+	{
+		if (!((span.ToCall < span.DigiPath) && (span.DigiPath < span.QFlag) && (span.QFlag < span.IGate) && (span.IGate < span.Content) && (span.Content < size)))
+		{
+
+			FuzzFail("FuzzPacket", "PacketSpan offsets out of order");
+		}
+	}
+
+	APRS::Packet packet;
+	APRS::Packet::Decode(packet, AL::String(lpLine, size));
+
+	return 0;
+}
@@ -0,0 +1,21 @@
+#include "Fuzz.hpp"
+
+// Input: packet content, see FuzzMakePacket
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* lpData, size_t size)
+{
+	auto packet = FuzzMakePacket(lpData, size);
+
+	APRS::Position value;
+	APRS::Position::Decode(value, packet);
+
+	// the allocation free fast path used by BatchDecoder and StationStore
+	if (size > APRS::Position::COORDINATES_LENGTH)
+	{
+		AL::Float        latitude, longitude;
+		AL::String::Char table, key;
+
+		APRS::Position::DecodeCoordinates(&packet.Content.GetCString()[1], latitude, longitude, table, key);
+	}
+
+	return 0;
+}
@@ -0,0 +1,112 @@
+#include "Fuzz.hpp"
+
+#include <vector>
+
+// Input: raw stream
+// Compares Tokenizer::Classify (AVX2/SSE2 when enabled) against ClassifyScalar at every
+// offset, and Tokenize/TokenizeLine/Find against a byte-at-a-time scan of the same input
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* lpData, size_t size)
+{
+	constexpr auto BLOCK_SIZE = APRS::Tokenizer::BLOCK_SIZE;
+
+	if (size == 0)
+	{
+
+		return 0;
+	}
+
+	auto lpBuffer = reinterpret_cast<const AL::String::Char*>(lpData);
+
+	// padded so every offset has a full block and unaligned loads are covered
+	std::vector<AL::String::Char> padded(size + BLOCK_SIZE, 0);
+	::memcpy(padded.data(), lpBuffer, size);
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		AL::uint64 lineFeeds, delimiters;
+		AL::uint64 scalarLineFeeds, scalarDelimiters;
+
+		APRS::Tokenizer::Classify(&padded[i], lineFeeds, delimiters);
+		APRS::Tokenizer::ClassifyScalar(&padded[i], scalarLineFeeds, scalarDelimiters);
+
+		if ((lineFeeds != scalarLineFeeds) || (delimiters != scalarDelimiters))
+		{
+
+			FuzzFail("FuzzTokenizer", "Classify != ClassifyScalar");
+		}
+
+		auto offset = APRS::Tokenizer::Find(&lpBuffer[i], size - i, lpBuffer[size - 1]);
+		auto lpFind = static_cast<const AL::String::Char*>(::memchr(&lpBuffer[i], lpBuffer[size - 1], size - i));
+
+		if (offset != static_cast<size_t>(lpFind - &lpBuffer[i]))
+		{
+
+			FuzzFail("FuzzTokenizer", "Find != memchr");
+		}
+	}
+
+	std::vector<APRS::TokenizerLine> lines(size + 1);
+	AL::size_t                       consumed;
+	auto                             count = APRS::Tokenizer::Tokenize(lpBuffer, size, lines.data(), lines.size(), consumed);
+
+	AL::size_t expectedCount    = 0;
+	AL::size_t expectedConsumed = 0;
+
+	for (size_t i = 0, begin = 0; i < size; ++i)
+	{
+		if (lpBuffer[i] != '\n')
+		{
+
+			continue;
+		}
+
+		auto  end  = ((i > begin) && (lpBuffer[i - 1] == '\r')) ? (i - 1) : i;
+		auto& line = lines[expectedCount++];
+
+		if ((expectedCount > count) || (line.Offset != begin) || (line.Length != (end - begin)))
+		{
+
+			FuzzFail("FuzzTokenizer", "Tokenize line offset/length");
+		}
+
+		APRS::TokenizerLine expected;
+		APRS::Tokenizer::TokenizeLine(&lpBuffer[begin], i - begin, expected);
+
+		AL::size_t delimiterCount = 0;
+
+		for (size_t j = begin; j < i; ++j)
+		{
+			if (!APRS::Tokenizer::IsDelimiter(lpBuffer[j]))
+			{
+
+				continue;
+			}
+
+			if ((delimiterCount < APRS::TokenizerLine::MAX_DELIMITERS) &&
+				((line.Delimiters[delimiterCount] != (j - begin)) || (expected.Delimiters[delimiterCount] != (j - begin))))
+			{
+
+				FuzzFail("FuzzTokenizer", "Tokenize delimiter offset");
+			}
+
+			++delimiterCount;
+		}
+
+		if ((line.DelimiterCount != delimiterCount) || (expected.DelimiterCount != delimiterCount))
+		{
+
+			FuzzFail("FuzzTokenizer", "Tokenize delimiter count");
+		}
+
+		begin            = i + 1;
+		expectedConsumed = i + 1;
+	}
+
+	if ((count != expectedCount) || (consumed != expectedConsumed))
+	{
+
+		FuzzFail("FuzzTokenizer", "Tokenize line count");
+	}
+
+	return 0;
+}
@@ -0,0 +1,21 @@
+#include "Fuzz.hpp"
+
+// Input: packet content, see FuzzMakePacket
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* lpData, size_t size)
+{
+	auto packet = FuzzMakePacket(lpData, size);
+
+	APRS::Weather value;
+	APRS::Weather::Decode(value, packet);
+
+	// positions with weather data in the comment
+	APRS::Position position;
+
+	if (APRS::Position::Decode(position, packet))
+	{
+
+		APRS::Weather::Decode(value, position);
+	}
+
+	return 0;
+}